@@ -0,0 +1,125 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// contention of atomic_optional<T> against a mutex protected optional<T>: every thread
+// publishes a reading every 16 operations and loads the current one otherwise. Reported is
+// the aggregate time per operation of all threads.
+//
+//   atomic_optional [operations] [max threads]
+
+#include <optional/atomic_optional.hpp>
+#include "bench.hpp"
+
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct small_reading { // 4 bytes + flag: native 8 byte atomic
+	std::uint32_t micros;
+};
+
+struct medium_reading { // 12 bytes + flag: 16 byte compare-and-swap with AVX, seqlock otherwise
+	float value;
+	std::uint32_t sensor;
+	std::uint32_t sequence;
+};
+
+struct large_reading { // 48 bytes + flag: seqlock
+	double values[5];
+	std::uint64_t sequence;
+};
+
+template <typename T>
+T make_reading(std::uint64_t i) {
+	T r{};
+	std::memcpy(&r, &i, sizeof(i) < sizeof(T) ? sizeof(i) : sizeof(T));
+	return r;
+}
+
+template <typename T>
+class locked_optional {
+	mutable std::mutex lock_;
+	boost::optional<T> value_;
+
+public:
+	boost::optional<T> load() const {
+		std::scoped_lock guard(lock_);
+		return value_;
+	}
+	void store(const boost::optional<T> & o) {
+		std::scoped_lock guard(lock_);
+		value_ = o;
+	}
+};
+
+template <typename Cell, typename T>
+void contend(const char * cell_name, const char * type_name, std::size_t operations, unsigned threads) {
+	Cell cell;
+	char label[128];
+	std::snprintf(label, sizeof(label), "%-26s %-15s %2u threads", cell_name, type_name, threads);
+
+	bench::measure(label, operations, [&](std::size_t n) {
+		std::vector<std::thread> workers;
+		for (unsigned t = 0; t < threads; ++t) {
+			workers.emplace_back([&, t] {
+				std::uint64_t engaged = 0;
+				for (std::size_t i = t; i < n; i += threads) {
+					if (i % 16 == 0)
+						cell.store(i % 64 ? boost::optional<T>{ make_reading<T>(i) } : boost::none);
+					else
+						engaged += cell.load().has_value();
+				}
+				bench::do_not_optimize(engaged);
+			});
+		}
+		for (auto & w : workers)
+			w.join();
+	}, 3);
+}
+
+template <typename T>
+void run_type(const char * type_name, std::size_t operations, unsigned max_threads) {
+	std::printf("%s: atomic_optional is %slock-free\n", type_name,
+	            boost::atomic_optional<T>::is_always_lock_free ? "" : "not ");
+	for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+		contend<boost::atomic_optional<T>, T>("atomic_optional", type_name, operations, threads);
+		contend<locked_optional<T>, T>("mutex + optional", type_name, operations, threads);
+	}
+}
+
+// a minimal functional check before measuring
+void verify() {
+	boost::atomic_optional<medium_reading> cell;
+	std::vector<std::thread> workers;
+	for (std::uint32_t t = 0; t < 4; ++t) {
+		workers.emplace_back([&, t] {
+			for (std::uint32_t i = 0; i < 10000; ++i) {
+				cell.store(medium_reading{ static_cast<float>(i), t, i });
+				const auto r = cell.load();
+				if (!r || r->value != static_cast<float>(r->sequence))
+					bench::fail("torn atomic_optional<medium_reading>");
+			}
+		});
+	}
+	for (auto & w : workers)
+		w.join();
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t operations = bench::arg_or(argc, argv, 1, std::size_t{ 1 } << 22);
+	const auto hardware          = std::max(1u, std::thread::hardware_concurrency());
+	const auto max_threads       = static_cast<unsigned>(bench::arg_or(argc, argv, 2, hardware));
+
+	verify();
+	run_type<small_reading>("4 bytes", operations, max_threads);
+	run_type<medium_reading>("12 bytes", operations, max_threads);
+	run_type<large_reading>("48 bytes", operations, max_threads);
+}
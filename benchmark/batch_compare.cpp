@@ -0,0 +1,156 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// cross-checks the batch comparison kernels against the scalar relational operators,
+// then compares their throughput
+//
+//   batch_compare [elements]
+
+#include <optional/optional_compare.hpp>
+#include "bench.hpp"
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace boost;
+
+namespace {
+
+constexpr relop all_relops[] = { relop::equal, relop::not_equal, relop::less,
+                                 relop::less_equal, relop::greater, relop::greater_equal };
+constexpr const char * relop_names[] = { "==", "!=", "<", "<=", ">", ">=" };
+
+// the operators are named explicitly: with libstdc++ 12, the rewritten candidates of std::optional
+// make ordering comparisons between two optionals recurse endlessly in constraint checking. The
+// relational operators are those rewritten from == and <=>.
+template <typename T, typename U>
+bool scalar_relop(relop op, const T & lhs, const U & rhs) {
+	switch (op) {
+		case relop::equal: return boost::operator==(lhs, rhs);
+		case relop::not_equal: return !boost::operator==(lhs, rhs);
+		case relop::less: return boost::operator<=>(lhs, rhs) < 0;
+		case relop::less_equal: return boost::operator<=>(lhs, rhs) <= 0;
+		case relop::greater: return boost::operator<=>(lhs, rhs) > 0;
+		default: return boost::operator<=>(lhs, rhs) >= 0;
+	}
+}
+
+template <typename T>
+T random_value() {
+	// a narrow value range makes equal payloads frequent
+	if constexpr (std::is_floating_point_v<T>) {
+		if (bench::engaged(0.01))
+			return std::numeric_limits<T>::quiet_NaN();
+		return static_cast<T>(std::uniform_int_distribution<int>{ -8, 8 }(bench::rng())) / 2;
+	} else {
+		return static_cast<T>(std::uniform_int_distribution<int>{ -8, 8 }(bench::rng()));
+	}
+}
+
+template <typename T>
+struct columns {
+	std::vector<optional<T>> rows;
+	optional_vector<T> column;
+
+	columns(std::size_t n, double ratio) {
+		rows.reserve(n);
+		for (std::size_t i = 0; i < n; ++i) {
+			if (bench::engaged(ratio))
+				rows.emplace_back(random_value<T>());
+			else
+				rows.emplace_back();
+			column.push_back(rows.back());
+		}
+	}
+};
+
+template <typename T, typename R>
+void verify(relop op, const std::vector<optional<T>> & lhs, const R & rhs, const std::vector<dtl::validity_word> & bits,
+            const char * what) {
+	for (std::size_t i = 0; i < lhs.size(); ++i) {
+		bool expected;
+		if constexpr (std::is_same_v<R, std::vector<optional<T>>>)
+			expected = scalar_relop(op, lhs[i], rhs[i]);
+		else
+			expected = scalar_relop(op, lhs[i], rhs);
+		if (dtl::test_bit(bits.data(), i) != expected)
+			bench::fail(what);
+	}
+	if (lhs.size() % dtl::validity_bits && bits.back() >> (lhs.size() % dtl::validity_bits))
+		bench::fail("bits beyond the end");
+}
+
+template <typename T>
+void cross_check(std::size_t n) {
+	const columns<T> a(n, 0.5), b(n, 0.5);
+	const T scalar = random_value<T>() + T{ 1 };
+	std::vector<dtl::validity_word> bits(dtl::validity_words(n));
+	for (relop op : all_relops) {
+		verify(op, a.rows, scalar, batch_compare(op, a.column, scalar), "column vs. scalar");
+		verify(op, a.rows, b.rows, batch_compare(op, a.column, b.column), "column vs. column");
+		batch_compare(op, std::span<const optional<T>>(a.rows), scalar, bits.data());
+		verify(op, a.rows, scalar, bits, "optionals vs. scalar");
+		batch_compare(op, std::span<const optional<T>>(a.rows), std::span<const optional<T>>(b.rows), bits.data());
+		verify(op, a.rows, b.rows, bits, "optionals vs. optionals");
+	}
+}
+
+template <typename T>
+void run(const char * type, std::size_t n) {
+	for (std::size_t size : { std::size_t{ 0 }, std::size_t{ 1 }, std::size_t{ 63 }, std::size_t{ 64 }, std::size_t{ 65 },
+	                          std::size_t{ 1000 } })
+		cross_check<T>(size);
+
+	const columns<T> a(n, 0.5), b(n, 0.5);
+	const T scalar = T{ 1 };
+	std::vector<dtl::validity_word> bits(dtl::validity_words(n));
+	for (std::size_t o = 0; o < std::size(all_relops); ++o) {
+		const relop op = all_relops[o];
+		const std::string prefix = std::string(type) + " " + relop_names[o] + " ";
+		bench::measure(prefix + "scalar operator, optional vs. value", n, [&](std::size_t) {
+			std::fill(bits.begin(), bits.end(), 0);
+			for (std::size_t i = 0; i < n; ++i)
+				bits[i / 64] |= dtl::validity_word{ scalar_relop(op, a.rows[i], scalar) } << (i % 64);
+			bench::do_not_optimize(bits.data());
+		});
+		bench::measure(prefix + "batch, optionals vs. value", n, [&](std::size_t) {
+			batch_compare(op, std::span<const optional<T>>(a.rows), scalar, bits.data());
+			bench::do_not_optimize(bits.data());
+		});
+		bench::measure(prefix + "batch, column vs. value", n, [&](std::size_t) {
+			batch_compare(op, a.column.values(), a.column.validity().data(), scalar, bits.data());
+			bench::do_not_optimize(bits.data());
+		});
+		bench::measure(prefix + "scalar operator, optional vs. optional", n, [&](std::size_t) {
+			std::fill(bits.begin(), bits.end(), 0);
+			for (std::size_t i = 0; i < n; ++i)
+				bits[i / 64] |= dtl::validity_word{ scalar_relop(op, a.rows[i], b.rows[i]) } << (i % 64);
+			bench::do_not_optimize(bits.data());
+		});
+		bench::measure(prefix + "batch, optionals vs. optionals", n, [&](std::size_t) {
+			batch_compare(op, std::span<const optional<T>>(a.rows), std::span<const optional<T>>(b.rows), bits.data());
+			bench::do_not_optimize(bits.data());
+		});
+		bench::measure(prefix + "batch, column vs. column", n, [&](std::size_t) {
+			batch_compare(op, a.column.values(), a.column.validity().data(), b.column.values(),
+			              b.column.validity().data(), bits.data());
+			bench::do_not_optimize(bits.data());
+		});
+	}
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t n = bench::arg_or(argc, argv, 1, std::size_t{ 1 } << 22);
+	run<std::int32_t>("int32", n);
+	run<std::int64_t>("int64", n);
+	run<float>("float", n);
+	run<double>("double", n);
+	std::printf("all batch comparisons match the scalar operators\n");
+}
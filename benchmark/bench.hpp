@@ -0,0 +1,71 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// minimal self-contained benchmarking support, no external dependencies
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string_view>
+
+namespace bench {
+
+template <typename T>
+inline void do_not_optimize(T const & value) {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static_cast<void>(*static_cast<const volatile T *>(&value));
+#endif
+}
+
+inline void clobber() {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : : "memory");
+#endif
+}
+
+using clock = std::chrono::steady_clock;
+
+// run f(iterations) repeatedly and report the best time per iteration of all repetitions
+template <typename F>
+double measure(std::string_view name, std::size_t iterations, F && f, int repetitions = 5) {
+	double best = 1e300;
+	for (int r = 0; r < repetitions; ++r) {
+		const auto start = clock::now();
+		f(iterations);
+		const std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+		best = std::min(best, elapsed.count() / static_cast<double>(iterations));
+	}
+	std::printf("%-56.*s %10.3f ns/op\n", static_cast<int>(name.size()), name.data(), best);
+	return best;
+}
+
+inline std::mt19937_64 & rng() {
+	static std::mt19937_64 engine{ 0x0B005700 };
+	return engine;
+}
+
+// true with probability ratio
+inline bool engaged(double ratio) {
+	return std::bernoulli_distribution{ ratio }(rng());
+}
+
+[[noreturn]] inline void fail(const char * what) {
+	std::fprintf(stderr, "verification failed: %s\n", what);
+	std::exit(EXIT_FAILURE);
+}
+
+inline std::size_t arg_or(int argc, char ** argv, int index, std::size_t fallback) {
+	return argc > index ? static_cast<std::size_t>(std::strtoull(argv[index], nullptr, 10)) : fallback;
+}
+
+} // namespace bench
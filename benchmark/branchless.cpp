@@ -0,0 +1,195 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// relational operators, three-way comparison and hash of optional<int> with randomly engaged
+// keys: std::optional branches on the engagement states, boost::optional folds them in without
+// branches. At 50% engagement every other branch is mispredicted, at 0% and 100% none is. Where
+// Linux exposes hardware counters, the mispredictions per operation are reported as well.
+//
+//   branchless [elements]
+
+#include <optional/optional.hpp>
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#if defined(__linux__)
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+namespace {
+
+// mispredicted branches in user space, if the hardware counter is available
+class branch_misses {
+	int fd_ = -1;
+
+public:
+	branch_misses() {
+#if defined(__linux__)
+		perf_event_attr attr{};
+		attr.type           = PERF_TYPE_HARDWARE;
+		attr.size           = sizeof(attr);
+		attr.config         = PERF_COUNT_HW_BRANCH_MISSES;
+		attr.disabled       = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv     = 1;
+		fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+	}
+	branch_misses(const branch_misses &) = delete;
+	~branch_misses() {
+#if defined(__linux__)
+		if (fd_ >= 0)
+			close(fd_);
+#endif
+	}
+
+	[[nodiscard]] bool available() const noexcept { return fd_ >= 0; }
+
+	// the mispredictions during f()
+	template <typename F>
+	std::uint64_t count(F && f) {
+		std::uint64_t misses = 0;
+#if defined(__linux__)
+		ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+		ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+		f();
+		ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+		if (read(fd_, &misses, sizeof(misses)) != sizeof(misses))
+			misses = 0;
+#else
+		f();
+#endif
+		return misses;
+	}
+};
+
+template <typename F>
+void measure(const char * label, std::size_t n, F && f) {
+	static branch_misses misses;
+	bench::measure(label, n, f);
+	if (misses.available()) {
+		const auto count = misses.count([&] { f(n); });
+		std::printf("%-56s %10.3f misses/op\n", "", static_cast<double>(count) / static_cast<double>(n));
+	}
+}
+
+template <typename O>
+std::vector<O> keys(std::size_t n, double ratio) {
+	std::vector<O> result(n);
+	for (auto & key : result)
+		if (bench::engaged(ratio))
+			key = static_cast<int>(bench::rng()() % 1000);
+	return result;
+}
+
+// the operators are named explicitly: with libstdc++ 12, the rewritten candidates of std::optional
+// make ordering comparisons between two boost::optionals recurse endlessly in constraint checking
+template <typename O>
+bool less(const O & lhs, const O & rhs) {
+	if constexpr (std::is_same_v<O, std::optional<int>>)
+		return lhs < rhs;
+	else
+		return boost::operator<=>(lhs, rhs) < 0;
+}
+template <typename O>
+auto three_way(const O & lhs, const O & rhs) {
+	if constexpr (std::is_same_v<O, std::optional<int>>)
+		return lhs <=> rhs;
+	else
+		return boost::operator<=>(lhs, rhs);
+}
+
+template <typename O>
+void run(const char * type_name, std::size_t n, double ratio) {
+	const std::vector<O> a = keys<O>(n, ratio);
+	const std::vector<O> b = keys<O>(n, ratio);
+	char label[96];
+
+	std::snprintf(label, sizeof(label), "%-23s %3.0f%%  count a == b", type_name, ratio * 100);
+	measure(label, n, [&](std::size_t) {
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < n; ++i)
+			count += a[i] == b[i];
+		bench::do_not_optimize(count);
+	});
+
+	std::snprintf(label, sizeof(label), "%-23s %3.0f%%  count a < b", type_name, ratio * 100);
+	measure(label, n, [&](std::size_t) {
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < n; ++i)
+			count += less(a[i], b[i]);
+		bench::do_not_optimize(count);
+	});
+
+	std::snprintf(label, sizeof(label), "%-23s %3.0f%%  count a < 500", type_name, ratio * 100);
+	measure(label, n, [&](std::size_t) {
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < n; ++i)
+			count += a[i] < 500;
+		bench::do_not_optimize(count);
+	});
+
+	std::snprintf(label, sizeof(label), "%-23s %3.0f%%  sum a <=> b", type_name, ratio * 100);
+	measure(label, n, [&](std::size_t) {
+		int sum = 0;
+		for (std::size_t i = 0; i < n; ++i) {
+			const auto order = three_way(a[i], b[i]);
+			sum += (order > 0) - (order < 0);
+		}
+		bench::do_not_optimize(sum);
+	});
+
+	std::snprintf(label, sizeof(label), "%-23s %3.0f%%  hash", type_name, ratio * 100);
+	measure(label, n, [&](std::size_t) {
+		std::size_t sum = 0;
+		for (std::size_t i = 0; i < n; ++i)
+			sum += std::hash<O>{}(a[i]);
+		bench::do_not_optimize(sum);
+	});
+
+	std::snprintf(label, sizeof(label), "%-23s %3.0f%%  sort", type_name, ratio * 100);
+	measure(label, n, [&](std::size_t) {
+		std::vector<O> sorted = a;
+		std::sort(sorted.begin(), sorted.end(), [](const O & lhs, const O & rhs) { return less(lhs, rhs); });
+		bench::do_not_optimize(sorted.front());
+	});
+}
+
+// both must agree on every result, and on the hash values
+void verify(std::size_t n) {
+	const auto a = keys<boost::optional<int>>(n, 0.5);
+	const auto b = keys<boost::optional<int>>(n, 0.5);
+	for (std::size_t i = 0; i < n; ++i) {
+		std::optional<int> sa, sb;
+		if (a[i].has_value())
+			sa = *a[i];
+		if (b[i].has_value())
+			sb = *b[i];
+		if ((a[i] == b[i]) != (sa == sb) || less(a[i], b[i]) != less(sa, sb) || (a[i] < 500) != (sa < 500) ||
+		    three_way(a[i], b[i]) != three_way(sa, sb))
+			bench::fail("relational operators");
+		if (std::hash<boost::optional<int>>{}(a[i]) != std::hash<std::optional<int>>{}(sa))
+			bench::fail("hash");
+	}
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t n = bench::arg_or(argc, argv, 1, 1 << 16);
+	verify(n);
+	for (const double ratio : { 0.5, 0.0, 1.0 }) {
+		run<std::optional<int>>("std::optional<int>", n, ratio);
+		run<boost::optional<int>>("boost::optional<int>", n, ratio);
+	}
+}
@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+# Copyright (C) 2020, Daniela Engert
+#
+# Use, modification, and distribution is subject to the Boost Software
+# License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+# http://www.boost.org/LICENSE_1_0.txt)
+#
+# compile-time throughput of optional.hpp: generates translation units that instantiate optional
+# over many payload types and measures wall time and peak memory of compiling them, consuming
+# optional as legacy header, header unit and named module. Configuration macros are passed with
+# --define, e.g. --define OPTIONAL_NO_THREE_WAY for the classic relational operators instead of
+# those rewritten from == and <=>.
+#
+#   compile_time.py [--compiler g++ --compiler clang++] [--types 200] [--units 4] [--repeat 3]
+#                   [--flavour include --flavour header-unit --flavour named-module] [--syntax-only]
+#                   [--define MACRO[=value]]...
+
+import argparse
+import os
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+HEADER = os.path.join(ROOT, 'optional', 'optional.hpp')
+MODULE = os.path.join(ROOT, 'optional', 'optional.cpp')
+
+PROLOGUE = {
+    'include': '#include <optional/optional.hpp>\n#include <optional>\n',
+    'header-unit': 'import "optional/optional.hpp";\n#include <optional>\n',
+    'named-module': '#include <optional>\nimport boost.optional;\n',
+}
+
+EXERCISE = '''
+template <typename T>
+int exercise(const T & v) {
+	boost::optional<T> a = v, b;
+	boost::optional<const T &> r = v;
+	std::optional<T> s = a;
+	boost::optional<T> c = s;
+	boost::optional<T> d{ std::optional<int>{ 1 } };
+	a = r;
+	b = boost::none;
+	c.emplace(v);
+	int n = (a == b) + (a != b) + (a == v) + (v == a) + (a != v) + (v != a);
+	n += (a < v) + (v < a) + (a <= v) + (v <= a) + (a > v) + (v > a) + (a >= v) + (v >= a);
+	n += (a == s) + (s == a) + (a != s) + (a == boost::none) + (boost::none < a);
+	n += a.map([](const T & x) { return x.v; }).value_or(0);
+	n += a.flat_map([](const T & x) { return boost::optional<int>{ x.v }; }).get_value_or(0);
+	n += r.map([](const T & x) { return x.v; }).value_or_eval([] { return 0; });
+	return n + d.has_value() + c.has_value();
+}
+'''
+
+TYPE = '''
+struct S{k} {{
+	int v = {k};
+	S{k}() = default;
+	explicit S{k}(int i) : v(i) {{}}
+	friend bool operator==(const S{k} &, const S{k} &) = default;
+	friend auto operator<=>(const S{k} &, const S{k} &) = default;
+}};
+'''
+
+
+def generate(path, flavour, unit, types):
+    with open(path, 'w') as f:
+        f.write(PROLOGUE[flavour])
+        f.write(EXERCISE)
+        f.write('namespace unit{} {{\n'.format(unit))
+        for k in range(types):
+            f.write(TYPE.format(k=k))
+        f.write('int run() {\n\treturn 0')
+        for k in range(types):
+            f.write('\n\t\t+ exercise(S{k}{{}})'.format(k=k))
+        f.write(';\n}\n}\n')
+
+
+def run(cmd, cwd):
+    """runs cmd, returns (seconds, peak resident set size in MiB) or None on failure"""
+    start = time.perf_counter()
+    proc = subprocess.Popen(cmd, cwd=cwd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    output = proc.stdout.read()
+    _, status, usage = os.wait4(proc.pid, 0)
+    proc.returncode = os.waitstatus_to_exitcode(status)
+    elapsed = time.perf_counter() - start
+    if proc.returncode != 0:
+        sys.stderr.write('  failed: {}\n{}\n'.format(' '.join(cmd), output.decode(errors='replace')[:2000]))
+        return None
+    return elapsed, usage.ru_maxrss / 1024
+
+
+def is_clang(compiler):
+    out = subprocess.run([compiler, '--version'], stdout=subprocess.PIPE, text=True).stdout
+    return 'clang' in out
+
+
+def module_commands(compiler, flavour, work, defines):
+    """returns (precompile command or None, extra flags for consuming translation units)"""
+    std = ['-std=c++20', '-I' + ROOT] + ['-D' + d for d in defines]
+    if flavour == 'include':
+        return None, std
+    clang = is_clang(compiler)
+    if flavour == 'header-unit':
+        if clang:
+            pcm = os.path.join(work, 'optional.hpp.pcm')
+            return (std + ['-xc++-user-header', '--precompile', HEADER, '-o', pcm],
+                    std + ['-fmodule-file=' + pcm])
+        return (std + ['-fmodules-ts', '-xc++-user-header', 'optional/optional.hpp'],
+                std + ['-fmodules-ts'])
+    module = ['-DOPTIONAL_NAMED_MODULE=boost.optional', '-DOPTIONAL_NOMINATED_INCLUDE="optional/optional.hpp"']
+    if clang:
+        pcm = os.path.join(work, 'boost.optional.pcm')
+        return (std + module + ['-xc++-module', '--precompile', MODULE, '-o', pcm],
+                std + ['-fmodule-file=boost.optional=' + pcm])
+    return (std + module + ['-fmodules-ts', '-c', MODULE, '-o', os.path.join(work, 'module.o')],
+            std + ['-fmodules-ts'])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--compiler', action='append')
+    parser.add_argument('--flavour', action='append', choices=sorted(PROLOGUE))
+    parser.add_argument('--types', type=int, default=200, help='payload types per translation unit')
+    parser.add_argument('--units', type=int, default=4, help='translation units')
+    parser.add_argument('--repeat', type=int, default=3)
+    parser.add_argument('--syntax-only', action='store_true', help='measure the front end only')
+    parser.add_argument('--keep', action='store_true', help='keep the generated sources')
+    parser.add_argument('--define', action='append', default=[], metavar='MACRO[=value]',
+                        help='configuration macro for optional.hpp')
+    args = parser.parse_args()
+
+    compilers = args.compiler or [c for c in ('g++', 'clang++') if shutil.which(c)]
+    flavours = args.flavour or ['include', 'header-unit', 'named-module']
+
+    print('{:<10} {:<13} {:<12} {:>9} {:>9}'.format('compiler', 'flavour', 'step', 'seconds', 'MiB'))
+    for compiler in compilers:
+        for flavour in flavours:
+            work = tempfile.mkdtemp(prefix='optional-compile-time-')
+            try:
+                precompile, flags = module_commands(compiler, flavour, work, args.define)
+                if precompile:
+                    result = run([compiler] + precompile, work)
+                    if result is None:
+                        print('{:<10} {:<13} {:<12} {:>9}'.format(compiler, flavour, 'precompile', 'failed'))
+                        continue
+                    print('{:<10} {:<13} {:<12} {:>9.2f} {:>9.1f}'.format(compiler, flavour, 'precompile', *result))
+                times, peaks = [], []
+                for unit in range(args.units):
+                    source = os.path.join(work, 'unit{}.cpp'.format(unit))
+                    generate(source, flavour, unit, args.types)
+                    for _ in range(args.repeat):
+                        output = ['-fsyntax-only'] if args.syntax_only else ['-c', '-o', source + '.o']
+                        result = run([compiler] + flags + output + [source], work)
+                        if result is None:
+                            break
+                        times.append(result[0])
+                        peaks.append(result[1])
+                    else:
+                        continue
+                    break
+                if len(times) != args.units * args.repeat:
+                    print('{:<10} {:<13} {:<12} {:>9}'.format(compiler, flavour, 'units', 'failed'))
+                    continue
+                print('{:<10} {:<13} {:<12} {:>9.2f} {:>9.1f}'.format(
+                    compiler, flavour, 'per unit', statistics.median(times), max(peaks)))
+            finally:
+                if args.keep:
+                    print('  sources kept in ' + work)
+                else:
+                    shutil.rmtree(work, ignore_errors=True)
+
+
+if __name__ == '__main__':
+    main()
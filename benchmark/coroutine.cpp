@@ -0,0 +1,99 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// a chain of five steps each returning optional<int>, of which a fraction of the inputs fails
+// at a random step: written with early returns, as nested flat_map lambdas, and as a coroutine
+// co_awaiting every step
+//
+//   coroutine [inputs]
+
+#include <optional/optional_coroutine.hpp>
+#include "bench.hpp"
+
+#include <vector>
+
+using boost::none;
+using boost::optional;
+
+namespace {
+
+struct input {
+	int value;
+	int fails_at; // the failing step, or -1
+};
+
+const input * current = nullptr;
+
+optional<int> step(int x, int k) {
+	if (current->fails_at == k)
+		return none;
+	return x * 3 + k;
+}
+
+optional<int> early_return(int x) {
+	const auto a = step(x, 0);
+	if (!a)
+		return none;
+	const auto b = step(*a, 1);
+	if (!b)
+		return none;
+	const auto c = step(*b, 2);
+	if (!c)
+		return none;
+	const auto d = step(*c, 3);
+	if (!d)
+		return none;
+	return step(*d, 4);
+}
+
+optional<int> flat_map_chain(int x) {
+	return step(x, 0).flat_map([](int a) {
+		return step(a, 1).flat_map([](int b) {
+			return step(b, 2).flat_map([](int c) {
+				return step(c, 3).flat_map([](int d) { return step(d, 4); });
+			});
+		});
+	});
+}
+
+optional<int> coroutine(int x) {
+	const int a = co_await step(x, 0);
+	const int b = co_await step(a, 1);
+	const int c = co_await step(b, 2);
+	const int d = co_await step(c, 3);
+	co_return co_await step(d, 4);
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t n = bench::arg_or(argc, argv, 1, 1 << 20);
+
+	for (double ratio : { 0.0, 0.1, 0.5 }) {
+		std::vector<input> inputs;
+		for (std::size_t i = 0; i < n; ++i)
+			inputs.push_back({ static_cast<int>(bench::rng()() % 1000),
+			                   bench::engaged(ratio) ? static_cast<int>(bench::rng()() % 5) : -1 });
+
+		const auto run = [&](const char * name, auto chain) {
+			char label[96];
+			std::snprintf(label, sizeof(label), "%-14s %3d%% failing", name, static_cast<int>(ratio * 100));
+			long long sum = 0;
+			bench::measure(label, n, [&](std::size_t) {
+				sum = 0;
+				for (const auto & in : inputs) {
+					current = &in;
+					sum += chain(in.value).value_or(-1);
+				}
+				bench::do_not_optimize(sum);
+			});
+			return sum;
+		};
+		const long long expected = run("early return", early_return);
+		if (run("flat_map", flat_map_chain) != expected || run("coroutine", coroutine) != expected)
+			bench::fail("results differ");
+	}
+}
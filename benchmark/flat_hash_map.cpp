@@ -0,0 +1,108 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// insert, successful and failing lookup, and erase of random 64 bit keys: std::unordered_map
+// allocates a node per element and chases a pointer per lookup, flat_hash_map stores the elements
+// inline and probes 16 control bytes at once. The sizes grow by factors of 10 from 1M up to the
+// given maximum; 100M elements need some 5 GiB of memory for std::unordered_map.
+//
+//   flat_hash_map [maximum elements]
+
+#include <optional/flat_hash_map.hpp>
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// times f after an untimed prepare, reports the best time per element of all repetitions
+template <typename Prepare, typename F>
+void measure(const char * label, std::size_t n, int repetitions, Prepare && prepare, F && f) {
+	double best = 1e300;
+	for (int r = 0; r < repetitions; ++r) {
+		prepare();
+		const auto start = bench::clock::now();
+		f();
+		const std::chrono::duration<double, std::nano> elapsed = bench::clock::now() - start;
+		best = std::min(best, elapsed.count() / static_cast<double>(n));
+	}
+	std::printf("%-56s %10.3f ns/op\n", label, best);
+}
+
+template <typename Map>
+void run(const char * map_name, const std::vector<std::uint64_t> & keys, const std::vector<std::uint64_t> & probes,
+         const std::vector<std::uint64_t> & misses) {
+	const std::size_t n   = keys.size();
+	const int repetitions = n > 10'000'000 ? 1 : 3;
+	char label[96];
+	Map map;
+	const auto fill = [&] {
+		map = Map{};
+		for (const auto key : keys)
+			map.try_emplace(key, key);
+	};
+
+	std::snprintf(label, sizeof(label), "%-24s %4zuM  insert", map_name, n / 1'000'000);
+	measure(label, n, repetitions, [&] { map = Map{}; }, [&] {
+		for (const auto key : keys)
+			map.try_emplace(key, key);
+	});
+
+	std::snprintf(label, sizeof(label), "%-24s %4zuM  lookup hit", map_name, n / 1'000'000);
+	measure(label, n, repetitions, [] {}, [&] {
+		std::uint64_t sum = 0;
+		for (const auto key : probes)
+			sum += map.find(key)->second;
+		bench::do_not_optimize(sum);
+		if (sum == 0)
+			bench::fail("lookup hit");
+	});
+
+	std::snprintf(label, sizeof(label), "%-24s %4zuM  lookup miss", map_name, n / 1'000'000);
+	measure(label, n, repetitions, [] {}, [&] {
+		std::size_t found = 0;
+		for (const auto key : misses)
+			found += map.contains(key);
+		bench::do_not_optimize(found);
+		if (found != 0)
+			bench::fail("lookup miss");
+	});
+
+	std::snprintf(label, sizeof(label), "%-24s %4zuM  erase", map_name, n / 1'000'000);
+	measure(label, n, repetitions, fill, [&] {
+		for (const auto key : probes)
+			map.erase(key);
+		if (!map.empty())
+			bench::fail("erase");
+	});
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t maximum = bench::arg_or(argc, argv, 1, 10'000'000);
+	auto & rng                = bench::rng();
+
+	for (std::size_t n = 1'000'000; n <= maximum; n *= 10) {
+		// keys are odd, misses even, so they never collide
+		std::vector<std::uint64_t> keys(n), misses(n);
+		for (std::size_t i = 0; i < n; ++i) {
+			keys[i]   = rng() | 1;
+			misses[i] = rng() & ~std::uint64_t{ 1 };
+		}
+		std::sort(keys.begin(), keys.end());
+		keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+		std::shuffle(keys.begin(), keys.end(), rng);
+		std::vector<std::uint64_t> probes = keys;
+		std::shuffle(probes.begin(), probes.end(), rng);
+
+		run<std::unordered_map<std::uint64_t, std::uint64_t>>("std::unordered_map", keys, probes, misses);
+		run<boost::flat_hash_map<std::uint64_t, std::uint64_t>>("boost::flat_hash_map", keys, probes, misses);
+	}
+}
@@ -0,0 +1,100 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// records with two large members engaged in 5% of the instances, held inline in optional<T> or
+// out of line in indirect_optional<T> with std::allocator and the default pool_allocator:
+// building the records, scanning their small members, and scanning the engaged large ones.
+//
+//   indirect_optional [records]
+
+#include <optional/indirect_optional.hpp>
+#include "bench.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace {
+
+struct attachment {
+	std::uint64_t checksum;
+	char bytes[248];
+};
+
+template <template <typename> class Optional>
+struct record {
+	std::uint64_t id;
+	double score;
+	Optional<attachment> original;
+	Optional<attachment> revised;
+};
+
+template <typename T>
+using inline_optional = boost::optional<T>;
+template <typename T>
+using heap_optional = boost::indirect_optional<T, std::allocator<T>>;
+template <typename T>
+using pooled_optional = boost::indirect_optional<T>;
+
+template <template <typename> class Optional>
+void run(const char * name, const std::vector<char> & engagement) {
+	using records   = std::vector<record<Optional>>;
+	const auto n    = engagement.size();
+	const auto fill = [&](records & rs) {
+		rs.reserve(n);
+		for (std::size_t i = 0; i < n; ++i) {
+			auto & r = rs.emplace_back(record<Optional>{ i, static_cast<double>(i & 1023), {}, {} });
+			if (engagement[i] & 1)
+				r.original = attachment{ i, {} };
+			if (engagement[i] & 2)
+				r.revised = attachment{ ~i, {} };
+		}
+	};
+	char label[96];
+
+	std::snprintf(label, sizeof(label), "%-27s%4zuB  build", name, sizeof(record<Optional>));
+	bench::measure(label, n, [&](std::size_t) {
+		records rs;
+		fill(rs);
+		bench::do_not_optimize(rs.data());
+	}, 3);
+
+	records rs;
+	fill(rs);
+
+	std::snprintf(label, sizeof(label), "%-27s%4zuB  scan scores", name, sizeof(record<Optional>));
+	bench::measure(label, n, [&](std::size_t) {
+		double total = 0;
+		for (const auto & r : rs)
+			total += r.score;
+		bench::do_not_optimize(total);
+	});
+
+	std::snprintf(label, sizeof(label), "%-27s%4zuB  scan attachments", name, sizeof(record<Optional>));
+	bench::measure(label, n, [&](std::size_t) {
+		std::uint64_t sum = 0;
+		for (const auto & r : rs) {
+			sum += r.original.map([](const attachment & a) { return a.checksum; }).value_or(0);
+			if (const auto * revised = r.revised.get_ptr())
+				sum += revised->checksum;
+		}
+		bench::do_not_optimize(sum);
+	});
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t n = bench::arg_or(argc, argv, 1, 1 << 20);
+	std::vector<char> engagement(n);
+	for (auto & e : engagement)
+		e = static_cast<char>(bench::engaged(0.05) | bench::engaged(0.05) << 1);
+
+	run<inline_optional>("optional<T>", engagement);
+	run<heap_optional>("indirect_optional<T>, heap", engagement);
+	run<pooled_optional>("indirect_optional<T>, pool", engagement);
+}
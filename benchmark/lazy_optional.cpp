@@ -0,0 +1,86 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// ingestion of records with an expensive derived field which is read for a fraction of the
+// records only: computed eagerly into optional<T>, or deferred with lazy_optional<T, F>
+//
+//   lazy_optional [records]
+
+#include <optional/lazy_optional.hpp>
+#include "bench.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+std::string normalize(std::string_view raw) {
+	std::string result;
+	result.reserve(raw.size());
+	for (char c : raw)
+		if (c != ' ')
+			result += static_cast<char>(c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c);
+	return result;
+}
+
+struct deferred {
+	std::string_view raw;
+	std::string operator()() const { return normalize(raw); }
+};
+
+struct eager_record {
+	std::string_view raw;
+	boost::optional<std::string> normalized;
+};
+
+struct lazy_record {
+	std::string_view raw;
+	boost::lazy_optional<std::string, deferred> normalized;
+};
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t n = bench::arg_or(argc, argv, 1, std::size_t{ 1 } << 16);
+
+	std::vector<std::string> input;
+	for (std::size_t i = 0; i < n; ++i)
+		input.push_back("record number " + std::to_string(i) + " with some free text to normalize");
+
+	for (double ratio : { 0.01, 0.1, 0.5, 1.0 }) {
+		std::vector<bool> read;
+		for (std::size_t i = 0; i < n; ++i)
+			read.push_back(bench::engaged(ratio));
+
+		char label[96];
+		std::snprintf(label, sizeof(label), "optional       %3d%% read", static_cast<int>(ratio * 100));
+		bench::measure(label, n, [&](std::size_t) {
+			std::vector<eager_record> records;
+			records.reserve(n);
+			for (const auto & raw : input)
+				records.push_back({ raw, normalize(raw) });
+			std::size_t sum = 0;
+			for (std::size_t i = 0; i < n; ++i)
+				if (read[i])
+					sum += records[i].normalized->size();
+			bench::do_not_optimize(sum);
+		});
+
+		std::snprintf(label, sizeof(label), "lazy_optional  %3d%% read", static_cast<int>(ratio * 100));
+		bench::measure(label, n, [&](std::size_t) {
+			std::vector<lazy_record> records;
+			records.reserve(n);
+			for (const auto & raw : input)
+				records.push_back({ raw, deferred{ raw } });
+			std::size_t sum = 0;
+			for (std::size_t i = 0; i < n; ++i)
+				if (read[i])
+					sum += records[i].normalized->size();
+			bench::do_not_optimize(sum);
+		});
+	}
+}
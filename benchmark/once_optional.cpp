@@ -0,0 +1,85 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// read-mostly lookups of a lazily computed shared value: once_optional<T> against optional<T>
+// guarded by a mutex and by std::call_once. Reported is the aggregate time per access of all
+// threads.
+//
+//   once_optional [accesses] [max threads]
+
+#include <optional/once_optional.hpp>
+#include "bench.hpp"
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::string compute() {
+	return "a lazily computed value exceeding the small string buffer";
+}
+
+struct once_cache {
+	boost::once_optional<std::string> value;
+	const std::string & get() { return value.value_or_eval(compute); }
+};
+
+struct mutex_cache {
+	std::mutex lock;
+	boost::optional<std::string> value;
+	const std::string & get() {
+		std::scoped_lock guard(lock);
+		if (!value)
+			value = compute();
+		return *value;
+	}
+};
+
+struct call_once_cache {
+	std::once_flag flag;
+	boost::optional<std::string> value;
+	const std::string & get() {
+		std::call_once(flag, [this] { value = compute(); });
+		return *value;
+	}
+};
+
+template <typename Cache>
+void lookup(const char * name, std::size_t accesses, unsigned threads) {
+	char label[128];
+	std::snprintf(label, sizeof(label), "%-16s %2u threads", name, threads);
+
+	bench::measure(label, accesses, [&](std::size_t n) {
+		Cache cache;
+		std::vector<std::thread> workers;
+		for (unsigned t = 0; t < threads; ++t) {
+			workers.emplace_back([&, t] {
+				std::size_t sum = 0;
+				for (std::size_t i = t; i < n; i += threads)
+					sum += cache.get().size();
+				bench::do_not_optimize(sum);
+			});
+		}
+		for (auto & w : workers)
+			w.join();
+	}, 3);
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t accesses = bench::arg_or(argc, argv, 1, std::size_t{ 1 } << 24);
+	const auto hardware        = std::max(1u, std::thread::hardware_concurrency());
+	const auto max_threads     = static_cast<unsigned>(bench::arg_or(argc, argv, 2, hardware));
+
+	for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+		lookup<once_cache>("once_optional", accesses, threads);
+		lookup<mutex_cache>("mutex + optional", accesses, threads);
+		lookup<call_once_cache>("std::call_once", accesses, threads);
+	}
+}
@@ -0,0 +1,303 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// the hot paths of boost::optional<T> against std::optional<T> and plain T
+//
+//   optional_bench [elements]
+
+#include <optional/optional.hpp>
+#include <optional/optional_pipeline.hpp>
+#include "bench.hpp"
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// minimal in-place factories in the spirit of Boost.Utility
+namespace boost {
+class in_place_factory_base {};
+class typed_in_place_factory_base {};
+} // namespace boost
+
+template <typename T, typename... Args>
+class typed_factory : public boost::typed_in_place_factory_base {
+	std::tuple<Args...> args_;
+
+public:
+	explicit typed_factory(Args... args) : args_(args...) {}
+	void * apply(void * address) const {
+		return std::apply([address](const Args &... a) { return ::new (address) T(a...); }, args_);
+	}
+};
+
+namespace {
+
+// payload types: trivially copyable, small string optimized and heavy
+
+struct heavy {
+	std::vector<int> data;
+	std::string name;
+
+	heavy() = default;
+	explicit heavy(int seed) : data(16, seed), name("heavyweight payload #" + std::to_string(seed)) {}
+	friend bool operator==(const heavy &, const heavy &) = default;
+	friend auto operator<=>(const heavy & lhs, const heavy & rhs) { return lhs.data <=> rhs.data; }
+};
+
+template <typename T>
+T make_payload(int seed) {
+	if constexpr (std::is_same_v<T, std::string>)
+		return std::to_string(seed % 1000000); // fits into the SSO buffer
+	else
+		return T(seed);
+}
+
+} // namespace
+
+template <>
+struct std::hash<heavy> {
+	std::size_t operator()(const heavy & h) const noexcept { return std::hash<std::string>{}(h.name); }
+};
+
+namespace {
+
+// the three flavours share one vocabulary: make, empty, engaged, value
+
+template <typename T>
+struct plain {
+	using type = T;
+	static constexpr const char * name = "T";
+	static T make(const T & v) { return v; }
+	static T empty() { return T{}; }
+	static bool engaged(const T &) { return true; }
+	static const T & value(const T & v) { return v; }
+};
+
+template <typename T>
+struct std_flavour {
+	using type = std::optional<T>;
+	static constexpr const char * name = "std::optional";
+	static type make(const T & v) { return type{ v }; }
+	static type empty() { return type{}; }
+	static bool engaged(const type & o) { return o.has_value(); }
+	static const T & value(const type & o) { return *o; }
+};
+
+template <typename T>
+struct boost_flavour {
+	using type = boost::optional<T>;
+	static constexpr const char * name = "boost::optional";
+	static type make(const T & v) { return type{ v }; }
+	static type empty() { return type{}; }
+	static bool engaged(const type & o) { return o.has_value(); }
+	static const T & value(const type & o) { return *o; }
+};
+
+template <typename T>
+using flavours = std::tuple<plain<T>, std_flavour<T>, boost_flavour<T>>;
+
+template <typename F, typename T>
+std::vector<typename F::type> make_inputs(std::size_t n, double ratio) {
+	std::vector<typename F::type> result;
+	result.reserve(n);
+	for (std::size_t i = 0; i < n; ++i)
+		result.push_back(bench::engaged(ratio) ? F::make(make_payload<T>(static_cast<int>(i))) : F::empty());
+	return result;
+}
+
+template <typename F, typename T>
+void run_flavour(const char * type_name, std::size_t n, double ratio) {
+	using O = typename F::type;
+	const auto inputs = make_inputs<F, T>(n, ratio);
+	const auto others = make_inputs<F, T>(n, ratio);
+	std::vector<T> values;
+	for (std::size_t i = 0; i < n; ++i)
+		values.push_back(make_payload<T>(static_cast<int>(i)));
+
+	char label[128];
+	const auto name = [&](const char * what) {
+		std::snprintf(label, sizeof(label), "%-11s %-15s %3d%% %s", type_name, F::name, static_cast<int>(ratio * 100),
+		              what);
+		return std::string_view(label);
+	};
+
+	auto storage = std::make_unique<std::aligned_storage_t<sizeof(O), alignof(O)>[]>(n);
+	O * const raw = reinterpret_cast<O *>(storage.get());
+
+	bench::measure(name("construct + destroy"), n, [&](std::size_t) {
+		for (std::size_t i = 0; i < n; ++i)
+			std::construct_at(raw + i, F::engaged(inputs[i]) ? F::make(values[i]) : F::empty());
+		bench::clobber();
+		std::destroy_n(raw, n);
+	});
+
+	bench::measure(name("copy construct"), n, [&](std::size_t) {
+		std::vector<O> copy = inputs;
+		bench::do_not_optimize(copy.data());
+	});
+
+	std::vector<O> scratch = inputs;
+	bench::measure(name("copy assign"), n, [&](std::size_t) {
+		for (std::size_t i = 0; i < n; ++i)
+			scratch[i] = others[i];
+		bench::do_not_optimize(scratch.data());
+	});
+
+	std::vector<O> sources(n);
+	bench::measure(name("move construct"), n, [&](std::size_t) {
+		sources = inputs;
+		bench::clobber();
+		std::vector<O> moved(std::make_move_iterator(sources.begin()), std::make_move_iterator(sources.end()));
+		bench::do_not_optimize(moved.data());
+	});
+
+	if constexpr (!std::is_same_v<F, plain<T>>) {
+		bench::measure(name("emplace"), n, [&](std::size_t) {
+			for (std::size_t i = 0; i < n; ++i)
+				scratch[i].emplace(values[i]);
+			bench::do_not_optimize(scratch.data());
+		});
+		if constexpr (std::is_same_v<F, boost_flavour<T>>) {
+			bench::measure(name("emplace_from"), n, [&](std::size_t) {
+				for (std::size_t i = 0; i < n; ++i)
+					scratch[i].emplace_from([&] { return make_payload<T>(static_cast<int>(i)); });
+				bench::do_not_optimize(scratch.data());
+			});
+		}
+	} else {
+		bench::measure(name("emplace (assign)"), n, [&](std::size_t) {
+			for (std::size_t i = 0; i < n; ++i)
+				scratch[i] = values[i];
+			bench::do_not_optimize(scratch.data());
+		});
+	}
+
+	// a chain of two maps and one flat_map, collapsed to a size
+	const auto f = [](const T & v) { return std::hash<T>{}(v); };
+	const auto g = [](std::size_t h) { return h * 0x9E3779B97F4A7C15ull; };
+	const auto h = [](std::size_t x) -> boost::optional<std::size_t> {
+		if (x & 1)
+			return x >> 1;
+		return boost::none;
+	};
+	bench::measure(name("map/map/flat_map chain"), n, [&](std::size_t) {
+		std::size_t sum = 0;
+		for (const O & o : inputs) {
+			if constexpr (std::is_same_v<F, boost_flavour<T>>) {
+				sum += o.map(f).map(g).flat_map(h).value_or(0);
+			} else if constexpr (std::is_same_v<F, std_flavour<T>>) {
+				if (o) {
+					const auto r = h(g(f(*o)));
+					sum += r ? *r : 0;
+				}
+			} else {
+				const auto r = h(g(f(o)));
+				sum += r ? *r : 0;
+			}
+		}
+		bench::do_not_optimize(sum);
+	});
+
+	// the same five stages as member chain and as fused pipeline
+	if constexpr (std::is_same_v<F, boost_flavour<T>>) {
+		const auto k = [](std::size_t x) { return x ^ (x >> 29); };
+		bench::measure(name("five stage member chain"), n, [&](std::size_t) {
+			std::size_t sum = 0;
+			for (const O & o : inputs)
+				sum += o.map(f).map(g).flat_map(h).map(k).map(g).value_or(0);
+			bench::do_not_optimize(sum);
+		});
+		bench::measure(name("five stage pipeline"), n, [&](std::size_t) {
+			std::size_t sum = 0;
+			for (const O & o : inputs)
+				sum += o | boost::then(f) | boost::then(g) | boost::and_then(h) | boost::then(k) | boost::then(g) |
+				       boost::value_or(std::size_t{ 0 });
+			bench::do_not_optimize(sum);
+		});
+	}
+
+	// projecting into a member: map copies it, transform refers to it
+	if constexpr (std::is_same_v<F, boost_flavour<T>> && std::is_same_v<T, heavy>) {
+		const auto size = [](const std::string & s) { return s.size(); };
+		bench::measure(name("map member projection"), n, [&](std::size_t) {
+			std::size_t sum = 0;
+			for (const O & o : inputs)
+				sum += o.map([](const heavy & x) { return x.name; }).map(size).value_or(0);
+			bench::do_not_optimize(sum);
+		});
+		bench::measure(name("transform member projection"), n, [&](std::size_t) {
+			std::size_t sum = 0;
+			for (const O & o : inputs)
+				sum += o.transform(&heavy::name).transform(size).value_or(0);
+			bench::do_not_optimize(sum);
+		});
+	}
+
+	const T fallback = make_payload<T>(-1);
+	bench::measure(name("value_or_eval"), n, [&](std::size_t) {
+		std::size_t sum = 0;
+		for (const O & o : inputs) {
+			if constexpr (std::is_same_v<F, boost_flavour<T>>)
+				sum += f(o.value_or_eval([&] { return fallback; }));
+			else if constexpr (std::is_same_v<F, std_flavour<T>>)
+				sum += f(o ? *o : fallback);
+			else
+				sum += f(o);
+		}
+		bench::do_not_optimize(sum);
+	});
+
+	if constexpr (std::is_same_v<F, boost_flavour<T>>) {
+		bench::measure(name("factory construct"), n, [&](std::size_t) {
+			for (std::size_t i = 0; i < n; ++i)
+				std::construct_at(raw + i, typed_factory<T, T>(values[i]));
+			bench::clobber();
+			std::destroy_n(raw, n);
+		});
+		bench::measure(name("factory assign"), n, [&](std::size_t) {
+			for (std::size_t i = 0; i < n; ++i)
+				scratch[i] = typed_factory<T, T>(values[i]);
+			bench::do_not_optimize(scratch.data());
+		});
+	}
+
+	bench::measure(name("== optional"), n, [&](std::size_t) {
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < n; ++i)
+			count += inputs[i] == others[i];
+		bench::do_not_optimize(count);
+	});
+
+	bench::measure(name("< value"), n, [&](std::size_t) {
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < n; ++i)
+			count += inputs[i] < fallback;
+		bench::do_not_optimize(count);
+	});
+
+	bench::measure(name("std::hash"), n, [&](std::size_t) {
+		std::size_t sum = 0;
+		for (const O & o : inputs)
+			sum += std::hash<O>{}(o);
+		bench::do_not_optimize(sum);
+	});
+}
+
+template <typename T>
+void run_type(const char * type_name, std::size_t n) {
+	for (double ratio : { 0.1, 0.5, 0.9 })
+		std::apply([&]<typename... F>(F...) { (run_flavour<F, T>(type_name, n, ratio), ...); }, flavours<T>{});
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t n = bench::arg_or(argc, argv, 1, std::size_t{ 1 } << 16);
+	run_type<int>("int", n);
+	run_type<std::string>("std::string", n);
+	run_type<heavy>("heavy", n);
+}
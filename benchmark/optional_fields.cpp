@@ -0,0 +1,122 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// rows of four optional<int32_t> and four optional<double> fields, randomly engaged, as a struct
+// of optionals and as optional_fields: summing two fields, counting rows with two given fields
+// engaged, and merging a patch into each row.
+//
+//   optional_fields [rows]
+
+#include <optional/optional_fields.hpp>
+#include "bench.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct row_struct {
+	boost::optional<std::int32_t> id, count, rank, flags;
+	boost::optional<double> price, weight, score, ratio;
+};
+
+using row_fields = boost::optional_fields<std::int32_t, std::int32_t, std::int32_t, std::int32_t, double, double,
+                                          double, double>;
+
+template <typename Row>
+void fill(std::vector<Row> & rows) {
+	for (auto & r : rows) {
+		auto draw = [] { return static_cast<std::int32_t>(bench::rng()() % 1000); };
+		if constexpr (std::is_same_v<Row, row_struct>) {
+			r = { bench::engaged(0.5) ? boost::optional<std::int32_t>(draw()) : boost::none,
+			      bench::engaged(0.5) ? boost::optional<std::int32_t>(draw()) : boost::none,
+			      bench::engaged(0.5) ? boost::optional<std::int32_t>(draw()) : boost::none,
+			      bench::engaged(0.5) ? boost::optional<std::int32_t>(draw()) : boost::none,
+			      bench::engaged(0.5) ? boost::optional<double>(draw()) : boost::none,
+			      bench::engaged(0.5) ? boost::optional<double>(draw()) : boost::none,
+			      bench::engaged(0.5) ? boost::optional<double>(draw()) : boost::none,
+			      bench::engaged(0.5) ? boost::optional<double>(draw()) : boost::none };
+		} else {
+			[&]<std::size_t... I>(std::index_sequence<I...>) {
+				((bench::engaged(0.5) ? void(r.template set<I>(draw())) : void()), ...);
+			}(std::make_index_sequence<8>{});
+		}
+	}
+}
+
+// the per-row operations, written as one would for either layout
+double sum(const row_struct & r) { return r.id.value_or(0) + r.price.value_or(0); }
+double sum(const row_fields & r) {
+	const auto id    = r.get<0>();
+	const auto price = r.get<4>();
+	return (id ? *id : 0) + (price ? *price : 0);
+}
+
+bool complete(const row_struct & r) { return r.count && r.weight; }
+bool complete(const row_fields & r) { return r.all(row_fields::mask_of<1, 5>); }
+
+void merge(row_struct & r, const row_struct & patch) {
+	if (!r.id)
+		r.id = patch.id;
+	if (!r.count)
+		r.count = patch.count;
+	if (!r.rank)
+		r.rank = patch.rank;
+	if (!r.flags)
+		r.flags = patch.flags;
+	if (!r.price)
+		r.price = patch.price;
+	if (!r.weight)
+		r.weight = patch.weight;
+	if (!r.score)
+		r.score = patch.score;
+	if (!r.ratio)
+		r.ratio = patch.ratio;
+}
+void merge(row_fields & r, const row_fields & patch) { r.merge(patch); }
+
+template <typename Row>
+void run(const char * name, std::size_t n) {
+	std::vector<Row> rows(n), patches(n), merged;
+	fill(rows);
+	fill(patches);
+	char label[96];
+
+	std::snprintf(label, sizeof(label), "%-22s%4zuB  sum of two fields", name, sizeof(Row));
+	bench::measure(label, n, [&](std::size_t) {
+		double total = 0;
+		for (const auto & r : rows)
+			total += sum(r);
+		bench::do_not_optimize(total);
+	});
+
+	std::snprintf(label, sizeof(label), "%-22s%4zuB  count rows with two fields", name, sizeof(Row));
+	bench::measure(label, n, [&](std::size_t) {
+		std::size_t found = 0;
+		for (const auto & r : rows)
+			found += complete(r);
+		bench::do_not_optimize(found);
+	});
+
+	std::snprintf(label, sizeof(label), "%-22s%4zuB  merge patches", name, sizeof(Row));
+	bench::measure(label, n, [&](std::size_t) {
+		merged = rows;
+		for (std::size_t i = 0; i < n; ++i)
+			merge(merged[i], patches[i]);
+		bench::clobber();
+	});
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t n = bench::arg_or(argc, argv, 1, 1 << 20);
+	run<row_struct>("struct of optionals", n);
+	run<row_fields>("optional_fields", n);
+}
@@ -0,0 +1,122 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// null-aware reductions and transforms over a large range of randomly engaged optional<int>: a
+// plain serial loop, then the algorithms of optional_parallel.hpp on thread pools of 1, 2, 4, ...
+// up to the given number of threads, and with the standard execution policies. With libstdc++,
+// std::execution::par runs in parallel only if linked with -ltbb.
+//
+//   parallel [elements] [threads]
+
+#include <optional/optional_parallel.hpp>
+#include "bench.hpp"
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using values = std::vector<boost::optional<int>>;
+
+struct inputs {
+	values dense;
+	std::vector<boost::optional<std::uint8_t>> sparse; // engaged only at the end
+	values output;
+};
+
+template <typename Exec>
+void run(const std::string & name, Exec && exec, inputs & in) {
+	const std::size_t n = in.dense.size();
+	const auto first    = in.dense.cbegin();
+	const auto last     = in.dense.cend();
+	const auto label    = [&](const char * what) { return name + "  " + what; };
+	const int repeats   = 3;
+
+	bench::measure(label("count_engaged"), n, [&](std::size_t) {
+		bench::do_not_optimize(boost::count_engaged(exec, first, last));
+	}, repeats);
+	bench::measure(label("sum_engaged"), n, [&](std::size_t) {
+		bench::do_not_optimize(boost::sum_engaged(exec, first, last));
+	}, repeats);
+	bench::measure(label("mean_engaged"), n, [&](std::size_t) {
+		bench::do_not_optimize(boost::mean_engaged(exec, first, last));
+	}, repeats);
+	bench::measure(label("min_engaged"), n, [&](std::size_t) {
+		bench::do_not_optimize(boost::min_engaged(exec, first, last));
+	}, repeats);
+	bench::measure(label("max_engaged"), n, [&](std::size_t) {
+		bench::do_not_optimize(boost::max_engaged(exec, first, last));
+	}, repeats);
+	bench::measure(label("first_engaged"), n, [&](std::size_t) {
+		const auto it = boost::first_engaged(exec, in.sparse.cbegin(), in.sparse.cend());
+		if (it != in.sparse.cend() - 1)
+			bench::fail("first_engaged");
+	}, repeats);
+	bench::measure(label("transform_engaged"), n, [&](std::size_t) {
+		boost::transform_engaged(exec, first, last, in.output.begin(), [](int x) { return 2 * x + 1; });
+		bench::clobber();
+	}, repeats);
+}
+
+// the loops we had before, as the baseline
+void run_serial_loops(inputs & in) {
+	const std::size_t n = in.dense.size();
+	bench::measure("serial loop  count", n, [&](std::size_t) {
+		std::size_t count = 0;
+		for (const auto & o : in.dense)
+			if (o)
+				++count;
+		bench::do_not_optimize(count);
+	}, 3);
+	bench::measure("serial loop  sum", n, [&](std::size_t) {
+		int sum = 0;
+		for (const auto & o : in.dense)
+			if (o)
+				sum += *o;
+		bench::do_not_optimize(sum);
+	}, 3);
+	bench::measure("serial loop  min", n, [&](std::size_t) {
+		boost::optional<int> least;
+		for (const auto & o : in.dense)
+			if (o && (!least || *o < *least))
+				least = *o;
+		bench::do_not_optimize(least);
+	}, 3);
+	bench::measure("serial loop  transform", n, [&](std::size_t) {
+		for (std::size_t i = 0; i < n; ++i)
+			in.output[i] = in.dense[i].map([](int x) { return 2 * x + 1; });
+		bench::clobber();
+	}, 3);
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t n        = bench::arg_or(argc, argv, 1, std::size_t{ 1 } << 26);
+	const std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+	const std::size_t threads  = bench::arg_or(argc, argv, 2, hardware);
+
+	inputs in;
+	in.dense.resize(n);
+	in.sparse.resize(n);
+	in.output.resize(n);
+	for (auto & o : in.dense)
+		if (bench::engaged(0.5))
+			o = static_cast<int>(bench::rng()() % 2001) - 1000;
+	in.sparse.back() = std::uint8_t{ 1 };
+
+	run_serial_loops(in);
+	for (std::size_t t = 1; t <= threads; t = t < threads && 2 * t > threads ? threads : 2 * t) {
+		boost::thread_pool pool(static_cast<unsigned>(t));
+		run("thread_pool(" + std::to_string(t) + ")", pool, in);
+	}
+#ifdef __cpp_lib_execution
+	run("std::execution::seq", std::execution::seq, in);
+	run("std::execution::par_unseq", std::execution::par_unseq, in);
+#endif
+}
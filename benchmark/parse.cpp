@@ -0,0 +1,145 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// ingestion of a CSV file with columns of int64, double and int64 and a fifth of the fields
+// null, spelled empty, NULL or \N: a scalar loop splitting fields character by character and
+// parsing each into an optional, and the batch parser of optional_parse.hpp. The file is read in
+// chunks of whole records, times are per field and include reading the file.
+//
+//   parse [megabytes]
+
+#include <optional/optional_parse.hpp>
+#include "bench.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t chunk_size = std::size_t{ 16 } << 20;
+
+std::size_t generate(const std::filesystem::path & path, std::size_t bytes) {
+	std::ofstream out(path, std::ios::binary);
+	std::string record;
+	std::size_t fields = 0;
+	for (std::size_t written = 0; written < bytes; written += record.size(), fields += 3) {
+		record.clear();
+		for (int column = 0; column < 3; ++column) {
+			if (column != 0)
+				record += ',';
+			switch (bench::rng()() % 15) {
+				case 0: break;
+				case 1: record += "NULL"; break;
+				case 2: record += "\\N"; break;
+				default:
+					if (column == 1)
+						record += std::to_string(static_cast<double>(bench::rng()() % 100000000) / 1000.0);
+					else
+						record += std::to_string(static_cast<std::int64_t>(bench::rng()() >> 20) - (1ll << 43));
+			}
+		}
+		record += '\n';
+		out.write(record.data(), static_cast<std::streamsize>(record.size()));
+	}
+	return fields;
+}
+
+// calls f with chunks of whole records
+template <typename F>
+void for_each_chunk(const std::filesystem::path & path, F && f) {
+	std::ifstream in(path, std::ios::binary);
+	std::vector<char> buffer(chunk_size);
+	std::size_t carry = 0;
+	while (true) {
+		in.read(buffer.data() + carry, static_cast<std::streamsize>(buffer.size() - carry));
+		const std::size_t size = carry + static_cast<std::size_t>(in.gcount());
+		if (size == 0)
+			return;
+		const std::string_view text(buffer.data(), size);
+		const std::size_t records = in ? text.rfind('\n') + 1 : size;
+		f(text.substr(0, records));
+		carry = size - records;
+		std::memmove(buffer.data(), buffer.data() + records, carry);
+		if (!in && carry == 0)
+			return;
+	}
+}
+
+template <typename T>
+void scalar_field(std::string_view field, std::vector<boost::optional<T>> & column) {
+	if (field.empty() || field == "NULL" || field == "\\N") {
+		column.emplace_back();
+		return;
+	}
+	T value;
+	const auto [ptr, ec] = std::from_chars(field.data(), field.data() + field.size(), value);
+	if (ec != std::errc{} || ptr != field.data() + field.size())
+		bench::fail("scalar parse");
+	column.emplace_back(value);
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t megabytes = bench::arg_or(argc, argv, 1, 2048);
+	const auto path             = std::filesystem::temp_directory_path() / "optional_parse.csv";
+	const std::size_t fields    = generate(path, megabytes << 20);
+	std::printf("%zu MB, %zu fields\n", megabytes, fields);
+
+	std::size_t scalar_engaged = 0;
+	bench::measure("scalar loop into vector<optional>", fields, [&](std::size_t) {
+		std::vector<boost::optional<std::int64_t>> a;
+		std::vector<boost::optional<double>> b;
+		std::vector<boost::optional<std::int64_t>> c;
+		scalar_engaged = 0;
+		for_each_chunk(path, [&](std::string_view text) {
+			a.clear();
+			b.clear();
+			c.clear();
+			std::size_t begin = 0;
+			int column        = 0;
+			for (std::size_t i = 0; i < text.size(); ++i) {
+				if (text[i] != ',' && text[i] != '\n')
+					continue;
+				const auto field = text.substr(begin, i - begin);
+				switch (column) {
+					case 0: scalar_field(field, a); break;
+					case 1: scalar_field(field, b); break;
+					default: scalar_field(field, c); break;
+				}
+				column = text[i] == '\n' ? 0 : column + 1;
+				begin  = i + 1;
+			}
+			for (const auto & o : a)
+				scalar_engaged += o.has_value();
+			for (const auto & o : b)
+				scalar_engaged += o.has_value();
+			for (const auto & o : c)
+				scalar_engaged += o.has_value();
+		});
+	}, 1);
+
+	std::size_t batch_engaged = 0;
+	bench::measure("parse_records into optional_vector", fields, [&](std::size_t) {
+		boost::optional_vector<std::int64_t> a;
+		boost::optional_vector<double> b;
+		boost::optional_vector<std::int64_t> c;
+		batch_engaged = 0;
+		for_each_chunk(path, [&](std::string_view text) {
+			a.clear();
+			b.clear();
+			c.clear();
+			boost::parse_records(text, boost::field_format{}, a, b, c);
+			batch_engaged += a.count_engaged() + b.count_engaged() + c.count_engaged();
+		});
+	}, 1);
+
+	if (scalar_engaged != batch_engaged)
+		bench::fail("engaged fields differ");
+	std::filesystem::remove(path);
+}
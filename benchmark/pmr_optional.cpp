@@ -0,0 +1,101 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// request handlers allocating from a per-request monotonic arena: a pmr::vector of optional
+// pmr::strings is filled the way handlers do. std::optional passes no allocator down and its
+// strings land on the global heap; boost::optional takes part in uses-allocator construction.
+// Reported are global heap allocations and time per request.
+//
+//   pmr_optional [requests]
+
+#include <optional/optional.hpp>
+#include "bench.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+std::atomic<std::size_t> heap_allocations{ 0 };
+}
+
+void * operator new(std::size_t size) {
+	heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void * p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc{};
+}
+void * operator new(std::size_t size, std::align_val_t align) {
+	heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	const auto alignment = static_cast<std::size_t>(align);
+	if (void * p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment))
+		return p;
+	throw std::bad_alloc{};
+}
+void operator delete(void * p) noexcept {
+	std::free(p);
+}
+void operator delete(void * p, std::size_t) noexcept {
+	std::free(p);
+}
+void operator delete(void * p, std::align_val_t) noexcept {
+	std::free(p);
+}
+void operator delete(void * p, std::size_t, std::align_val_t) noexcept {
+	std::free(p);
+}
+
+namespace {
+
+constexpr std::size_t fields = 32;
+
+const std::pmr::string & source() {
+	static const std::pmr::string s{ "a header value which doesn't fit into the small string buffer" };
+	return s;
+}
+
+template <typename O>
+std::size_t handle_request(std::pmr::memory_resource * arena) {
+	std::pmr::vector<O> row(arena);
+	row.reserve(fields);
+	for (std::size_t i = 0; i < fields; ++i) {
+		switch (i % 4) {
+		case 0: row.emplace_back(); break;
+		case 1: row.emplace_back(source()); break;
+		case 2: row.push_back(O{ source() }); break; // the temporary itself is on the heap
+		default: row.emplace_back(std::in_place, 48, 'x'); break;
+		}
+	}
+	std::size_t sum = 0;
+	for (const auto & o : row)
+		sum += o ? o->size() : 0;
+	return sum;
+}
+
+template <typename O>
+void run(const char * name, std::size_t requests) {
+	static unsigned char buffer[1 << 16];
+	const std::size_t before = heap_allocations.load();
+	bench::measure(name, requests, [&](std::size_t n) {
+		for (std::size_t r = 0; r < n; ++r) {
+			std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+			bench::do_not_optimize(handle_request<O>(&arena));
+		}
+	}, 1);
+	std::printf("  %.1f heap allocations per request\n",
+	            static_cast<double>(heap_allocations.load() - before) / static_cast<double>(requests));
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t requests = bench::arg_or(argc, argv, 1, 100000);
+	run<std::optional<std::pmr::string>>("std::optional<pmr::string>", requests);
+	run<boost::optional<std::pmr::string>>("boost::optional<pmr::string>", requests);
+}
@@ -0,0 +1,122 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// growing and erasing from the middle of a sequence of optionals: std::vector moves and destroys
+// element by element, a minimal vector built on uninitialized_relocate moves trivially
+// relocatable elements in bulk. optional<std::string> isn't trivially relocatable with every
+// standard library and serves as control.
+//
+//   relocate [elements]
+
+#include <optional/optional_relocate.hpp>
+#include "bench.hpp"
+
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+// just enough of a vector to grow and to erase
+template <typename T>
+class relocating_vector {
+	T * data_             = nullptr;
+	std::size_t size_     = 0;
+	std::size_t capacity_ = 0;
+
+	static T * allocate(std::size_t n) {
+		return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t{ alignof(T) }));
+	}
+	static void deallocate(T * p) { ::operator delete(p, std::align_val_t{ alignof(T) }); }
+
+public:
+	relocating_vector() = default;
+	relocating_vector(const relocating_vector &) = delete;
+	~relocating_vector() {
+		std::destroy_n(data_, size_);
+		deallocate(data_);
+	}
+
+	template <typename... Args>
+	T & emplace_back(Args &&... args) {
+		if (size_ == capacity_) {
+			const std::size_t capacity = capacity_ ? 2 * capacity_ : 8;
+			T * data                   = allocate(capacity);
+			boost::uninitialized_relocate_n(data_, size_, data);
+			deallocate(data_);
+			data_     = data;
+			capacity_ = capacity;
+		}
+		return *std::construct_at(data_ + size_++, static_cast<Args &&>(args)...);
+	}
+
+	void erase(std::size_t i) {
+		std::destroy_at(data_ + i);
+		boost::uninitialized_relocate(data_ + i + 1, data_ + size_, data_ + i);
+		--size_;
+	}
+
+	[[nodiscard]] std::size_t size() const noexcept { return size_; }
+	[[nodiscard]] T & operator[](std::size_t i) noexcept { return data_[i]; }
+};
+
+template <typename T>
+T make(std::size_t i) {
+	static int targets[64];
+	using payload = typename T::value_type;
+	if (i % 4 == 0)
+		return boost::none;
+	if constexpr (std::is_same_v<payload, std::unique_ptr<int>>)
+		return std::make_unique<int>(static_cast<int>(i));
+	else if constexpr (std::is_same_v<payload, int &>)
+		return targets[i % 64];
+	else
+		return std::string(40, static_cast<char>('a' + i % 26));
+}
+
+template <typename Vector, typename T>
+void run(const char * vector_name, const char * type_name, std::size_t n) {
+	char label[96];
+	std::snprintf(label, sizeof(label), "%-17s %-25s grow", vector_name, type_name);
+	bench::measure(label, n, [&](std::size_t) {
+		Vector v;
+		for (std::size_t i = 0; i < n; ++i)
+			v.emplace_back(make<T>(i));
+		bench::do_not_optimize(v[n / 2]);
+	});
+
+	// then erase a quarter of the elements from the middle
+	std::snprintf(label, sizeof(label), "%-17s %-25s grow + erase", vector_name, type_name);
+	bench::measure(label, n, [&](std::size_t) {
+		Vector v;
+		for (std::size_t i = 0; i < n; ++i)
+			v.emplace_back(make<T>(i));
+		for (std::size_t i = 0; i < n / 4; ++i) {
+			if constexpr (std::is_same_v<Vector, std::vector<T>>)
+				v.erase(v.begin() + static_cast<std::ptrdiff_t>(v.size() / 2));
+			else
+				v.erase(v.size() / 2);
+		}
+		bench::do_not_optimize(v[0]);
+	});
+}
+
+template <typename T>
+void run_type(const char * type_name, std::size_t n) {
+	std::printf("%s is %strivially relocatable\n", type_name, boost::is_trivially_relocatable_v<T> ? "" : "not ");
+	run<std::vector<T>, T>("std::vector", type_name, n);
+	run<relocating_vector<T>, T>("relocating_vector", type_name, n);
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t n = bench::arg_or(argc, argv, 1, 1 << 14);
+	run_type<boost::optional<std::unique_ptr<int>>>("optional<unique_ptr<int>>", n);
+	run_type<boost::optional<int &>>("optional<int &>", n);
+	run_type<boost::optional<std::string>>("optional<string>", n);
+}
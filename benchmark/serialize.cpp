@@ -0,0 +1,133 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// writing and reading a column of optional<int> through a file: element by element as flag byte
+// plus payload and read back into a vector of optionals, or with optional_column_writer and read
+// in place from a memory-mapped file through optional_column_view. Times are per element and
+// include the file system.
+//
+//   serialize [elements]
+
+#include <optional/optional_serialize.hpp>
+#include "bench.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define SERIALIZE_HAS_MMAP 1
+#endif
+
+namespace {
+
+// the file contents, memory-mapped where available
+class mapped_file {
+	const std::byte * data_ = nullptr;
+	std::size_t size_       = 0;
+	std::vector<std::uint64_t> buffer_;
+
+public:
+	explicit mapped_file(const std::filesystem::path & path)
+	: size_(static_cast<std::size_t>(std::filesystem::file_size(path))) {
+#ifdef SERIALIZE_HAS_MMAP
+		const int fd = ::open(path.c_str(), O_RDONLY);
+		void * p     = fd >= 0 ? ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+		if (fd >= 0)
+			::close(fd);
+		if (p == MAP_FAILED)
+			bench::fail("mmap");
+		data_ = static_cast<const std::byte *>(p);
+#else
+		buffer_.resize((size_ + 7) / 8);
+		std::ifstream(path, std::ios::binary).read(reinterpret_cast<char *>(buffer_.data()), static_cast<std::streamsize>(size_));
+		data_ = reinterpret_cast<const std::byte *>(buffer_.data());
+#endif
+	}
+	mapped_file(const mapped_file &) = delete;
+	~mapped_file() {
+#ifdef SERIALIZE_HAS_MMAP
+		::munmap(const_cast<std::byte *>(data_), size_);
+#endif
+	}
+
+	[[nodiscard]] std::span<const std::byte> bytes() const noexcept { return { data_, size_ }; }
+};
+
+long long checksum(const boost::optional<int> & o) {
+	return o ? *o : -1;
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t n = bench::arg_or(argc, argv, 1, 100'000'000);
+	const auto path     = std::filesystem::temp_directory_path() / "optional_column.bin";
+
+	std::vector<boost::optional<int>> input;
+	input.reserve(n);
+	long long expected = 0;
+	for (std::size_t i = 0; i < n; ++i) {
+		input.push_back(bench::engaged(0.7) ? boost::optional<int>{ static_cast<int>(i) } : boost::none);
+		expected += checksum(input.back());
+	}
+
+	bench::measure("write flag + payload", n, [&](std::size_t) {
+		std::ofstream out(path, std::ios::binary);
+		for (const auto & o : input) {
+			const char flag = o.has_value();
+			const int value = o.value_or(0);
+			out.write(&flag, 1);
+			out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+		}
+	}, 1);
+	bench::measure("read flag + payload into vector<optional>", n, [&](std::size_t) {
+		std::ifstream in(path, std::ios::binary);
+		std::vector<boost::optional<int>> column;
+		column.reserve(n);
+		char flag;
+		int value;
+		while (in.read(&flag, 1) && in.read(reinterpret_cast<char *>(&value), sizeof(value)))
+			column.push_back(flag ? boost::optional<int>{ value } : boost::none);
+		long long sum = 0;
+		for (const auto & o : column)
+			sum += checksum(o);
+		if (sum != expected)
+			bench::fail("flag + payload");
+	}, 1);
+
+	for (auto layout : { boost::column_layout::dense, boost::column_layout::sparse }) {
+		const char * name = layout == boost::column_layout::dense ? "dense " : "sparse";
+		char label[96];
+		std::snprintf(label, sizeof(label), "write optional_column_writer %s", name);
+		bench::measure(label, n, [&](std::size_t) {
+			std::ofstream out(path, std::ios::binary);
+			boost::optional_column_writer<int> writer(out, layout);
+			writer.append(input);
+			if (!writer.finish())
+				bench::fail("write");
+		}, 1);
+		std::printf("  %.2f bytes per element\n",
+		            static_cast<double>(std::filesystem::file_size(path)) / static_cast<double>(n));
+
+		std::snprintf(label, sizeof(label), "read mapped optional_column_view %s", name);
+		bench::measure(label, n, [&](std::size_t) {
+			const mapped_file file(path);
+			const boost::optional_column_view<int> column(file.bytes());
+			long long sum = 0;
+			for (std::size_t i = 0; i < column.size(); ++i) {
+				const auto o = column[i];
+				sum += o ? *o : -1;
+			}
+			if (sum != expected)
+				bench::fail("optional_column_view");
+		}, 1);
+	}
+	std::filesystem::remove(path);
+}
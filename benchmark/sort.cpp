@@ -0,0 +1,92 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// sorting randomly engaged optional keys: std::sort and std::stable_sort compare whole optionals,
+// sort_optionals and stable_sort_optionals move the nones to the front and sort the payloads
+// alone, integers by radix sort, other payloads by pdqsort or merge sort. Each sort includes
+// copying the unsorted input.
+//
+//   sort [elements] [engaged percentage]
+
+#include <optional/optional_algorithm.hpp>
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+// the operator is named explicitly: with libstdc++ 12, the rewritten candidates of std::optional
+// make ordering comparisons between two boost::optionals recurse endlessly in constraint checking
+struct optional_less {
+	template <typename T>
+	bool operator()(const std::optional<T> & lhs, const std::optional<T> & rhs) const {
+		return lhs < rhs;
+	}
+	template <typename T>
+	bool operator()(const boost::optional<T> & lhs, const boost::optional<T> & rhs) const {
+		return boost::operator<=>(lhs, rhs) < 0;
+	}
+};
+
+template <typename T, typename Sort>
+void measure(const char * type_name, const char * what, const std::vector<T> & input, Sort sort) {
+	char label[96];
+	std::snprintf(label, sizeof(label), "%-30s %s", type_name, what);
+	bench::measure(label, input.size(), [&](std::size_t) {
+		std::vector<T> sorted = input;
+		sort(sorted);
+		bench::do_not_optimize(sorted.front());
+	});
+
+	std::vector<T> sorted = input;
+	sort(sorted);
+	if (!std::is_sorted(sorted.begin(), sorted.end(), optional_less{}))
+		bench::fail(label);
+}
+
+template <typename T, typename Make>
+void run(const char * std_name, const char * boost_name, std::size_t n, double ratio, Make make) {
+	std::vector<std::optional<T>> std_input(n);
+	std::vector<boost::optional<T>> input(n);
+	for (std::size_t i = 0; i < n; ++i)
+		if (bench::engaged(ratio)) {
+			input[i]     = make();
+			std_input[i] = *input[i];
+		}
+
+	using std_vector   = std::vector<std::optional<T>>;
+	using boost_vector = std::vector<boost::optional<T>>;
+	measure(std_name, "std::sort", std_input,
+	        [](std_vector & v) { std::sort(v.begin(), v.end(), optional_less{}); });
+	measure(boost_name, "std::sort", input,
+	        [](boost_vector & v) { std::sort(v.begin(), v.end(), optional_less{}); });
+	measure(boost_name, "sort_optionals", input, [](boost_vector & v) { boost::sort_optionals(v); });
+	measure(std_name, "std::stable_sort", std_input,
+	        [](std_vector & v) { std::stable_sort(v.begin(), v.end(), optional_less{}); });
+	measure(boost_name, "std::stable_sort", input,
+	        [](boost_vector & v) { std::stable_sort(v.begin(), v.end(), optional_less{}); });
+	measure(boost_name, "stable_sort_optionals", input, [](boost_vector & v) { boost::stable_sort_optionals(v); });
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t n   = bench::arg_or(argc, argv, 1, 1 << 20);
+	const double ratio    = static_cast<double>(bench::arg_or(argc, argv, 2, 80)) / 100;
+	auto & rng            = bench::rng();
+
+	run<std::uint64_t>("std::optional<uint64_t>", "boost::optional<uint64_t>", n, ratio, [&] { return rng(); });
+	run<std::int32_t>("std::optional<int32_t>", "boost::optional<int32_t>", n, ratio,
+	                  [&] { return static_cast<std::int32_t>(rng()); });
+	run<double>("std::optional<double>", "boost::optional<double>", n, ratio,
+	            [&] { return static_cast<double>(rng() % 1000000) / 8; });
+	run<std::string>("std::optional<string>", "boost::optional<string>", n / 4, ratio,
+	                 [&] { return "key " + std::to_string(rng() % 100000); });
+}
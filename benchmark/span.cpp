@@ -0,0 +1,53 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// an index lookup yielding an array of pointers, null for misses, handed to code consuming
+// optional<T &>: converting element by element into a vector of optionals versus viewing the
+// pointers in place with as_optionals. Both then sum the referred-to values.
+//
+//   span [elements]
+
+#include <optional/optional_span.hpp>
+#include "bench.hpp"
+
+#include <span>
+#include <vector>
+
+namespace {
+
+[[nodiscard]] long long sum(std::span<const boost::optional<int &>> values) {
+	long long result = 0;
+	for (const auto & value : values)
+		result += value ? *value : 0;
+	return result;
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t n = bench::arg_or(argc, argv, 1, 1 << 20);
+	std::vector<int> table(1024);
+	for (std::size_t i = 0; i < table.size(); ++i)
+		table[i] = static_cast<int>(i);
+	std::vector<int *> hits(n);
+	for (auto & hit : hits)
+		if (bench::engaged(0.9))
+			hit = &table[bench::rng()() % table.size()];
+
+	const long long expected = sum(boost::as_optionals(std::span<int * const>(hits)));
+	bench::measure("copy into vector<optional<int &>>, then sum", n, [&](std::size_t) {
+		std::vector<boost::optional<int &>> values;
+		values.reserve(hits.size());
+		for (int * hit : hits)
+			values.push_back(hit ? boost::optional<int &>(*hit) : boost::none);
+		if (sum(values) != expected)
+			bench::fail("copy");
+	});
+	bench::measure("view with as_optionals, then sum", n, [&](std::size_t) {
+		if (sum(boost::as_optionals(hits)) != expected)
+			bench::fail("view");
+	});
+}
@@ -0,0 +1,132 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+// sorting by optional keys: with operator<=>, records ordered by several optional keys compare
+// each key once per step. With operator< alone, a key that doesn't decide the order is compared
+// twice, lhs < rhs and rhs < lhs. Payload comparisons are counted. Build it once more with -DOPTIONAL_NO_THREE_WAY to measure the
+// classic relational operators of optional.
+//
+//   three_way [elements]
+
+#include <optional/optional.hpp>
+#include "bench.hpp"
+
+#include <algorithm>
+#include <compare>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::size_t payload_comparisons = 0;
+
+// a string which counts its comparisons
+struct name {
+	std::string s;
+
+	friend bool operator==(const name & lhs, const name & rhs) {
+		++payload_comparisons;
+		return lhs.s == rhs.s;
+	}
+	friend bool operator<(const name & lhs, const name & rhs) {
+		++payload_comparisons;
+		return lhs.s < rhs.s;
+	}
+	friend std::strong_ordering operator<=>(const name & lhs, const name & rhs) {
+		++payload_comparisons;
+		return lhs.s.compare(rhs.s) <=> 0;
+	}
+};
+
+struct record {
+	boost::optional<name> city;
+	boost::optional<name> street;
+	boost::optional<int> number;
+};
+
+// the operators are named explicitly: with libstdc++ 12, the rewritten candidates of std::optional
+// make ordering comparisons between two optionals recurse endlessly in constraint checking
+#ifdef OPTIONAL_NO_THREE_WAY
+constexpr const char * mode = "classic";
+
+template <typename T>
+bool less(const boost::optional<T> & lhs, const boost::optional<T> & rhs) {
+	return boost::operator<(lhs, rhs);
+}
+
+bool by_keys(const record & lhs, const record & rhs) {
+	if (boost::operator<(lhs.city, rhs.city))
+		return true;
+	if (boost::operator<(rhs.city, lhs.city))
+		return false;
+	if (boost::operator<(lhs.street, rhs.street))
+		return true;
+	if (boost::operator<(rhs.street, lhs.street))
+		return false;
+	return boost::operator<(lhs.number, rhs.number);
+}
+#else
+constexpr const char * mode = "three-way";
+
+template <typename T>
+bool less(const boost::optional<T> & lhs, const boost::optional<T> & rhs) {
+	return boost::operator<=>(lhs, rhs) < 0;
+}
+
+bool by_keys(const record & lhs, const record & rhs) {
+	if (const auto c = boost::operator<=>(lhs.city, rhs.city); c != 0)
+		return c < 0;
+	if (const auto c = boost::operator<=>(lhs.street, rhs.street); c != 0)
+		return c < 0;
+	return boost::operator<=>(lhs.number, rhs.number) < 0;
+}
+#endif
+
+boost::optional<name> random_name(std::size_t distinct) {
+	if (!bench::engaged(0.8))
+		return boost::none;
+	return name{ "district " + std::to_string(bench::rng()() % distinct) };
+}
+
+template <typename T, typename Less>
+void sort_and_count(const char * what, const std::vector<T> & input, Less less) {
+	char label[96];
+	std::snprintf(label, sizeof(label), "%-10s %s", mode, what);
+	bench::measure(label, input.size(), [&](std::size_t) {
+		std::vector<T> sorted = input;
+		std::sort(sorted.begin(), sorted.end(), less);
+		bench::do_not_optimize(sorted.front());
+	});
+
+	std::vector<T> sorted = input;
+	payload_comparisons = 0;
+	std::sort(sorted.begin(), sorted.end(), less);
+	if (payload_comparisons != 0)
+		std::printf("%-56s %10.3f payload comparisons/element\n", "",
+		            static_cast<double>(payload_comparisons) / static_cast<double>(input.size()));
+	if (!std::is_sorted(sorted.begin(), sorted.end(), less))
+		bench::fail(what);
+}
+
+} // namespace
+
+int main(int argc, char ** argv) {
+	const std::size_t n = bench::arg_or(argc, argv, 1, 1 << 15);
+
+	std::vector<boost::optional<int>> numbers(n);
+	std::vector<boost::optional<name>> names(n);
+	std::vector<record> records(n);
+	for (std::size_t i = 0; i < n; ++i) {
+		if (bench::engaged(0.8))
+			numbers[i] = static_cast<int>(bench::rng()() % 1000);
+		names[i]   = random_name(1000);
+		records[i] = { random_name(8), random_name(16), numbers[i] };
+	}
+
+	sort_and_count("sort optional<int>", numbers, less<int>);
+	sort_and_count("sort optional<name>", names, less<name>);
+	sort_and_count("sort records by 3 optional keys", records, by_keys);
+}
@@ -0,0 +1,422 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#pragma push_macro("OPTIONAL_NAMESPACE")
+#include "optional.hpp"
+#pragma pop_macro("OPTIONAL_NAMESPACE")
+
+#include <atomic>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// 16 byte cells need a double-width compare-and-swap for writers and an atomic 16 byte load for
+// readers. The latter is guaranteed for aligned vector loads by processors with AVX only.
+#if defined(__x86_64__) && defined(__AVX__) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+#  define OPTIONAL_ATOMIC_DWCAS
+#elif defined(_MSC_VER) && defined(_M_X64) && defined(__AVX__)
+#  define OPTIONAL_ATOMIC_DWCAS
+#  include <intrin.h>
+#endif
+
+#if defined(__has_builtin)
+#  if __has_builtin(__builtin_clear_padding)
+#    define OPTIONAL_CLEAR_PADDING(p) __builtin_clear_padding(p)
+#  endif
+#endif
+#if !defined(OPTIONAL_CLEAR_PADDING) && defined(_MSC_VER) && !defined(__clang__) && _MSC_VER >= 1928
+#  define OPTIONAL_CLEAR_PADDING(p) __builtin_zero_non_value_bits(p)
+#endif
+
+#ifndef OPTIONAL_NAMESPACE
+#define OPTIONAL_NAMESPACE boost
+#endif
+
+namespace OPTIONAL_NAMESPACE {
+namespace {
+namespace dtl {
+
+// an optional<T> is encoded into a cell of bytes: either T alone if the niche of T marks the
+// disengaged state, or T followed by a flag byte. Disengaged optionals encode as T's niche or as
+// all zero bytes respectively, such that every optional<T> has exactly one encoding. Padding
+// bits of T are cleared on encoding; without a means to do so, payloads with padding are rejected.
+template <typename T>
+inline constexpr bool atomic_niche = niche_type<T>;
+template <typename T>
+inline constexpr std::size_t atomic_cell_size = atomic_niche<T> ? sizeof(T) : sizeof(T) + 1;
+
+#if defined(OPTIONAL_CLEAR_PADDING)
+template <typename T>
+inline constexpr bool atomic_encodable = true;
+#else
+template <typename T>
+inline constexpr bool atomic_encodable = std::has_unique_object_representations_v<T> ||
+                                         (std::is_floating_point_v<T> && sizeof(T) <= sizeof(double));
+#endif
+
+template <typename T>
+void copy_value_bits(unsigned char * bytes, T v) noexcept {
+#if defined(OPTIONAL_CLEAR_PADDING)
+	OPTIONAL_CLEAR_PADDING(std::addressof(v));
+#endif
+	std::memcpy(bytes, std::addressof(v), sizeof(T));
+}
+
+template <typename T, typename Cell>
+[[nodiscard]] Cell encode(const optional<T> & o) noexcept {
+	static_assert(sizeof(Cell) >= atomic_cell_size<T>);
+	Cell cell{};
+	auto * bytes = reinterpret_cast<unsigned char *>(&cell);
+	if constexpr (atomic_niche<T>) {
+		copy_value_bits<T>(bytes, o.has_value() ? *o : optional_niche<T>::sentinel());
+	} else if (o.has_value()) {
+		copy_value_bits<T>(bytes, *o);
+		bytes[sizeof(T)] = 1;
+	}
+	return cell;
+}
+
+template <typename T, typename Cell>
+[[nodiscard]] optional<T> decode(const Cell & cell) noexcept {
+	const auto * bytes = reinterpret_cast<const unsigned char *>(&cell);
+	if constexpr (!atomic_niche<T>) {
+		if (bytes[sizeof(T)] == 0)
+			return none;
+	}
+	std::array<unsigned char, sizeof(T)> payload;
+	std::memcpy(payload.data(), bytes, sizeof(T));
+	const T v = std::bit_cast<T>(payload);
+	if constexpr (atomic_niche<T>) {
+		if (optional_niche<T>::is_sentinel(v))
+			return none;
+	}
+	return v;
+}
+
+[[nodiscard]] constexpr std::memory_order failure_order(std::memory_order order) noexcept {
+	return order == std::memory_order_acq_rel ? std::memory_order_acquire
+	     : order == std::memory_order_release ? std::memory_order_relaxed
+	                                          : order;
+}
+
+// cells of up to 8 bytes live in a native atomic integer
+template <typename T>
+class atomic_word_cell {
+	using word = std::conditional_t<(atomic_cell_size<T> <= 4), std::uint32_t, std::uint64_t>;
+
+	std::atomic<word> cell_;
+
+public:
+	static constexpr bool lock_free = std::atomic<word>::is_always_lock_free;
+
+	explicit atomic_word_cell(const optional<T> & o) noexcept : cell_(encode<T, word>(o)) {}
+
+	[[nodiscard]] optional<T> load(std::memory_order order) const noexcept {
+		return decode<T>(cell_.load(order));
+	}
+	void store(const optional<T> & o, std::memory_order order) noexcept {
+		cell_.store(encode<T, word>(o), order);
+	}
+	[[nodiscard]] optional<T> exchange(const optional<T> & o, std::memory_order order) noexcept {
+		return decode<T>(cell_.exchange(encode<T, word>(o), order));
+	}
+	bool compare_exchange(optional<T> & expected, const optional<T> & desired, bool weak,
+	                      std::memory_order success, std::memory_order failure) noexcept {
+		word e = encode<T, word>(expected);
+		const word d = encode<T, word>(desired);
+		const bool done = weak ? cell_.compare_exchange_weak(e, d, success, failure)
+		                       : cell_.compare_exchange_strong(e, d, success, failure);
+		if (!done)
+			expected = decode<T>(e);
+		return done;
+	}
+	void wait(const optional<T> & old, std::memory_order order) const noexcept {
+		cell_.wait(encode<T, word>(old), order);
+	}
+	void notify_one() noexcept { cell_.notify_one(); }
+	void notify_all() noexcept { cell_.notify_all(); }
+};
+
+#if defined(OPTIONAL_ATOMIC_DWCAS)
+struct alignas(16) dword {
+	std::uint64_t lo;
+	std::uint64_t hi;
+};
+
+// double-width compare-and-swap, a full barrier. On failure, expected receives the current value.
+inline bool dwcas(dword * target, dword & expected, const dword & desired) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+	return _InterlockedCompareExchange128(reinterpret_cast<volatile long long *>(target),
+	                                      static_cast<long long>(desired.hi), static_cast<long long>(desired.lo),
+	                                      reinterpret_cast<long long *>(&expected)) != 0;
+#else
+	__extension__ using u128 = unsigned __int128;
+	const u128 e    = std::bit_cast<u128>(expected);
+	const u128 prev = __sync_val_compare_and_swap(reinterpret_cast<u128 *>(target), e, std::bit_cast<u128>(desired));
+	expected        = std::bit_cast<dword>(prev);
+	return prev == e;
+#endif
+}
+
+// a single aligned vector load, which never writes to the cache line unlike a compare-and-swap
+// of the expected value with itself. On x86 it's as strongly ordered as the locked writes.
+[[nodiscard]] inline dword dload(const dword * source) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+	_ReadWriteBarrier();
+	const __m128i v = _mm_load_si128(reinterpret_cast<const __m128i *>(source));
+	_ReadWriteBarrier();
+	return std::bit_cast<dword>(v);
+#else
+	using vector = long long __attribute__((vector_size(16)));
+	vector v;
+	__asm__ __volatile__("vmovdqa %1, %0" : "=x"(v) : "m"(*source) : "memory");
+	return std::bit_cast<dword>(v);
+#endif
+}
+
+// cells of up to 16 bytes are swapped as a whole with cmpxchg16b and loaded with one vector load.
+// Waiting is delegated to an epoch counter bumped by notify.
+template <typename T>
+class atomic_dword_cell {
+	dword cell_;
+	std::atomic<std::uint32_t> epoch_{ 0 };
+
+	[[nodiscard]] dword current() const noexcept { return dload(&cell_); }
+
+public:
+	static constexpr bool lock_free = true;
+
+	explicit atomic_dword_cell(const optional<T> & o) noexcept : cell_(encode<T, dword>(o)) {}
+
+	[[nodiscard]] optional<T> load(std::memory_order) const noexcept { return decode<T>(current()); }
+	void store(const optional<T> & o, std::memory_order order) noexcept {
+		static_cast<void>(exchange(o, order));
+	}
+	[[nodiscard]] optional<T> exchange(const optional<T> & o, std::memory_order) noexcept {
+		const dword d = encode<T, dword>(o);
+		dword e       = current();
+		while (!dwcas(&cell_, e, d)) {}
+		return decode<T>(e);
+	}
+	bool compare_exchange(optional<T> & expected, const optional<T> & desired, bool,
+	                      std::memory_order, std::memory_order) noexcept {
+		dword e = encode<T, dword>(expected);
+		if (dwcas(&cell_, e, encode<T, dword>(desired)))
+			return true;
+		expected = decode<T>(e);
+		return false;
+	}
+	void wait(const optional<T> & old, std::memory_order) const noexcept {
+		const dword o = encode<T, dword>(old);
+		for (;;) {
+			const std::uint32_t epoch = epoch_.load(std::memory_order_acquire);
+			const dword now           = current();
+			if (now.lo != o.lo || now.hi != o.hi)
+				return;
+			epoch_.wait(epoch, std::memory_order_acquire);
+		}
+	}
+	void notify_one() noexcept {
+		epoch_.fetch_add(1, std::memory_order_release);
+		epoch_.notify_one();
+	}
+	void notify_all() noexcept {
+		epoch_.fetch_add(1, std::memory_order_release);
+		epoch_.notify_all();
+	}
+};
+#endif
+
+// larger cells are guarded by a seqlock: the sequence number is odd while a writer is active,
+// readers retry until they observe the same even sequence number before and after reading.
+// The cell is a sequence of relaxed atomic words to keep concurrent reads and writes race-free.
+template <typename T>
+class seqlock_cell {
+	static constexpr std::size_t words = (atomic_cell_size<T> + 7) / 8;
+	using block = std::array<std::uint64_t, words>;
+
+	std::atomic<std::uint64_t> sequence_{ 0 };
+	std::array<std::atomic<std::uint64_t>, words> cell_;
+
+	[[nodiscard]] block read() const noexcept {
+		block b;
+		for (std::uint64_t s0 = sequence_.load(std::memory_order_acquire);;) {
+			if ((s0 & 1) == 0) {
+				for (std::size_t i = 0; i < words; ++i)
+					b[i] = cell_[i].load(std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				const std::uint64_t s1 = sequence_.load(std::memory_order_relaxed);
+				if (s0 == s1)
+					return b;
+				s0 = s1;
+			} else {
+				s0 = sequence_.load(std::memory_order_acquire);
+			}
+		}
+	}
+
+	[[nodiscard]] std::uint64_t lock() noexcept {
+		std::uint64_t s = sequence_.load(std::memory_order_relaxed);
+		for (;;) {
+			if ((s & 1) == 0 && sequence_.compare_exchange_weak(s, s + 1, std::memory_order_acquire))
+				break;
+			if (s & 1)
+				s = sequence_.load(std::memory_order_relaxed);
+		}
+		std::atomic_thread_fence(std::memory_order_release);
+		return s + 1;
+	}
+	void write(const block & b) noexcept {
+		for (std::size_t i = 0; i < words; ++i)
+			cell_[i].store(b[i], std::memory_order_relaxed);
+	}
+	void unlock(std::uint64_t s) noexcept { sequence_.store(s + 1, std::memory_order_release); }
+
+	[[nodiscard]] block unlocked_read() const noexcept {
+		block b;
+		for (std::size_t i = 0; i < words; ++i)
+			b[i] = cell_[i].load(std::memory_order_relaxed);
+		return b;
+	}
+
+public:
+	static constexpr bool lock_free = false;
+
+	explicit seqlock_cell(const optional<T> & o) noexcept {
+		const block b = encode<T, block>(o);
+		for (std::size_t i = 0; i < words; ++i)
+			cell_[i].store(b[i], std::memory_order_relaxed);
+	}
+
+	[[nodiscard]] optional<T> load(std::memory_order) const noexcept { return decode<T>(read()); }
+	void store(const optional<T> & o, std::memory_order) noexcept {
+		const block b         = encode<T, block>(o);
+		const std::uint64_t s = lock();
+		write(b);
+		unlock(s);
+	}
+	[[nodiscard]] optional<T> exchange(const optional<T> & o, std::memory_order) noexcept {
+		const block b         = encode<T, block>(o);
+		const std::uint64_t s = lock();
+		const block previous  = unlocked_read();
+		write(b);
+		unlock(s);
+		return decode<T>(previous);
+	}
+	bool compare_exchange(optional<T> & expected, const optional<T> & desired, bool,
+	                      std::memory_order, std::memory_order) noexcept {
+		const block e         = encode<T, block>(expected);
+		const std::uint64_t s = lock();
+		const block current   = unlocked_read();
+		const bool equal      = current == e;
+		if (equal)
+			write(encode<T, block>(desired));
+		unlock(s);
+		if (!equal)
+			expected = decode<T>(current);
+		return equal;
+	}
+	void wait(const optional<T> & old, std::memory_order) const noexcept {
+		const block o = encode<T, block>(old);
+		for (;;) {
+			const std::uint64_t s = sequence_.load(std::memory_order_acquire);
+			if ((s & 1) == 0 && read() != o)
+				return;
+			sequence_.wait(s, std::memory_order_acquire);
+		}
+	}
+	void notify_one() noexcept { sequence_.notify_one(); }
+	void notify_all() noexcept { sequence_.notify_all(); }
+};
+
+template <typename T>
+using atomic_cell = std::conditional_t<(atomic_cell_size<T> <= 8), atomic_word_cell<T>,
+#if defined(OPTIONAL_ATOMIC_DWCAS)
+                    std::conditional_t<(atomic_cell_size<T> <= 16), atomic_dword_cell<T>,
+                    seqlock_cell<T>>>;
+#else
+                    seqlock_cell<T>>;
+#endif
+
+} // non-exported namespace dtl
+} // anonymous namespace
+
+// an atomic optional<T> for trivially copyable T with the interface of std::atomic. It's lock-free
+// if T plus an engaged flag (or just T if optional_niche<T> provides a niche) fits into 8 bytes,
+// or into 16 bytes on x86-64 targets with AVX and cmpxchg16b (-mavx -mcx16), whose readers then
+// don't write either. Elsewhere, and for larger payloads, a seqlock takes over: readers never
+// write, writers exclude each other. Operations on the 16 byte and seqlock representations are
+// always sequentially consistent.
+// Like std::atomic, compare_exchange compares value bits, not values: padding is ignored, but
+// 0.0 and -0.0 differ and a NaN matches itself.
+template <typename T>
+	requires (std::is_trivially_copyable_v<T> && std::is_object_v<T> && !std::is_const_v<T> &&
+	          !std::is_volatile_v<T> && dtl::atomic_encodable<T>)
+class atomic_optional {
+	dtl::atomic_cell<T> cell_;
+
+public:
+	using value_type = optional<T>;
+
+	static constexpr bool is_always_lock_free = dtl::atomic_cell<T>::lock_free;
+	[[nodiscard]] bool is_lock_free() const noexcept { return is_always_lock_free; }
+
+	atomic_optional() noexcept : cell_(optional<T>{}) {}
+	atomic_optional(const optional<T> & desired) noexcept : cell_(desired) {}
+	atomic_optional(const atomic_optional &) = delete;
+	atomic_optional & operator=(const atomic_optional &) = delete;
+
+	optional<T> operator=(const optional<T> & desired) noexcept {
+		store(desired);
+		return desired;
+	}
+	operator optional<T>() const noexcept { return load(); }
+
+	[[nodiscard]] optional<T> load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+		return cell_.load(order);
+	}
+	void store(const optional<T> & desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+		cell_.store(desired, order);
+	}
+	optional<T> exchange(const optional<T> & desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+		return cell_.exchange(desired, order);
+	}
+
+	bool compare_exchange_weak(optional<T> & expected, const optional<T> & desired,
+	                           std::memory_order success, std::memory_order failure) noexcept {
+		return cell_.compare_exchange(expected, desired, true, success, failure);
+	}
+	bool compare_exchange_weak(optional<T> & expected, const optional<T> & desired,
+	                           std::memory_order order = std::memory_order_seq_cst) noexcept {
+		return cell_.compare_exchange(expected, desired, true, order, dtl::failure_order(order));
+	}
+	bool compare_exchange_strong(optional<T> & expected, const optional<T> & desired,
+	                             std::memory_order success, std::memory_order failure) noexcept {
+		return cell_.compare_exchange(expected, desired, false, success, failure);
+	}
+	bool compare_exchange_strong(optional<T> & expected, const optional<T> & desired,
+	                             std::memory_order order = std::memory_order_seq_cst) noexcept {
+		return cell_.compare_exchange(expected, desired, false, order, dtl::failure_order(order));
+	}
+
+	// returns once the value differs from old, which is rechecked whenever notified
+	void wait(const optional<T> & old, std::memory_order order = std::memory_order_seq_cst) const noexcept {
+		cell_.wait(old, order);
+	}
+	void notify_one() noexcept { cell_.notify_one(); }
+	void notify_all() noexcept { cell_.notify_all(); }
+}; // class atomic_optional
+
+} // namespace OPTIONAL_NAMESPACE
+
+#undef OPTIONAL_ATOMIC_DWCAS
+#undef OPTIONAL_CLEAR_PADDING
+#undef OPTIONAL_NAMESPACE
@@ -0,0 +1,608 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#pragma push_macro("OPTIONAL_NAMESPACE")
+#include "optional_relocate.hpp"
+#pragma pop_macro("OPTIONAL_NAMESPACE")
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if !defined(OPTIONAL_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || _M_IX86_FP >= 2)
+#  define OPTIONAL_SIMD_SSE2
+#  include <emmintrin.h>
+#endif
+
+#ifndef OPTIONAL_NAMESPACE
+#define OPTIONAL_NAMESPACE boost
+#endif
+
+namespace OPTIONAL_NAMESPACE {
+namespace {
+namespace dtl {
+
+// one control byte per slot: the 7 low bits of the hash of a full slot's key, or one of the
+// negative markers. A slot is never full, empty, or was full and is deleted since.
+using control = std::int8_t;
+
+inline constexpr control ctrl_empty   = -128;
+inline constexpr control ctrl_deleted = -2;
+
+// a group of consecutive control bytes, matched at once. The result masks hold one bit per
+// matching byte, at position index << shift.
+#ifdef OPTIONAL_SIMD_SSE2
+struct probe_group {
+	static constexpr std::size_t width = 16;
+	static constexpr int shift         = 0;
+	using mask                         = std::uint32_t;
+
+	__m128i ctrl;
+
+	explicit probe_group(const control * p) noexcept
+	: ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))) {}
+
+	[[nodiscard]] mask match(control h2) const noexcept {
+		return static_cast<mask>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+	}
+	[[nodiscard]] mask match_empty() const noexcept { return match(ctrl_empty); }
+	// empty and deleted are the only control bytes below -1
+	[[nodiscard]] mask match_free() const noexcept {
+		return static_cast<mask>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl)));
+	}
+	[[nodiscard]] static std::size_t leading(mask m) noexcept { return static_cast<std::size_t>(std::countl_zero(m)) - 16; }
+};
+#else
+// eight bytes in a word: the high bit of each byte flags a match. match may flag false positives
+// next to a true one, which the key comparison weeds out.
+struct probe_group {
+	static constexpr std::size_t width = 8;
+	static constexpr int shift         = 3;
+	using mask                         = std::uint64_t;
+
+	static constexpr mask lsbs = 0x0101'0101'0101'0101;
+	static constexpr mask msbs = 0x8080'8080'8080'8080;
+
+	mask ctrl = 0;
+
+	explicit probe_group(const control * p) noexcept {
+		for (std::size_t i = 0; i < width; ++i)
+			ctrl |= mask{ static_cast<std::uint8_t>(p[i]) } << (8 * i);
+	}
+
+	[[nodiscard]] mask match(control h2) const noexcept {
+		const mask x = ctrl ^ (lsbs * static_cast<std::uint8_t>(h2));
+		return (x - lsbs) & ~x & msbs;
+	}
+	[[nodiscard]] mask match_empty() const noexcept { return ctrl & ~(ctrl << 6) & msbs; }
+	[[nodiscard]] mask match_free() const noexcept { return ctrl & ~(ctrl << 7) & msbs; }
+	[[nodiscard]] static std::size_t leading(mask m) noexcept { return static_cast<std::size_t>(std::countl_zero(m)) >> shift; }
+};
+#endif
+
+[[nodiscard]] inline std::size_t lowest(probe_group::mask m) noexcept {
+	return static_cast<std::size_t>(std::countr_zero(m)) >> probe_group::shift;
+}
+
+// hashes like std::hash of integers are the identity, the bits are spread before being split
+// into the probe start h1 and the control byte h2
+[[nodiscard]] constexpr std::size_t mix_hash(std::size_t hash) noexcept {
+	std::uint64_t x = hash;
+	x ^= x >> 33;
+	x *= 0xFF51'AFD7'ED55'8CCDull;
+	x ^= x >> 33;
+	return static_cast<std::size_t>(x);
+}
+[[nodiscard]] constexpr std::size_t h1(std::size_t hash) noexcept { return hash >> 7; }
+[[nodiscard]] constexpr control h2(std::size_t hash) noexcept { return static_cast<control>(hash & 0x7F); }
+
+// at most 7/8 of the slots are taken, so every probe sequence meets an empty slot
+[[nodiscard]] constexpr std::size_t max_load(std::size_t capacity) noexcept { return capacity - capacity / 8; }
+
+struct key_of_pair {
+	template <typename Pair>
+	[[nodiscard]] constexpr const auto & operator()(const Pair & p) const noexcept { return p.first; }
+};
+struct key_of_self {
+	template <typename Key>
+	[[nodiscard]] constexpr const Key & operator()(const Key & k) const noexcept { return k; }
+};
+
+// open addressing after the Swiss table design: the slots hold bare values, whether a slot is
+// full lives in a separate array of control bytes. Lookups compare the control bytes of a whole
+// group against h2 at once and touch values only on matches, groups are probed quadratically.
+// Capacities are powers of two not below the group width, the first group's control bytes are
+// mirrored behind the last one so that every group load is contiguous.
+template <typename Value, typename Key, typename KeyOf, typename Hash, typename KeyEqual>
+class flat_table {
+	static constexpr std::size_t width     = probe_group::width;
+	static constexpr std::size_t alignment = alignof(Value) > width ? alignof(Value) : width;
+	// results of the probe callbacks besides a slot index
+	static constexpr std::size_t next_group = ~std::size_t{ 0 };
+	static constexpr std::size_t not_found  = next_group - 1;
+
+	control * ctrl_          = nullptr;
+	Value * slots_           = nullptr;
+	std::size_t capacity_    = 0;
+	std::size_t size_        = 0;
+	std::size_t growth_left_ = 0;
+	[[no_unique_address]] Hash hash_;
+	[[no_unique_address]] KeyEqual equal_;
+
+	template <bool Const>
+	class basic_iterator {
+		friend flat_table;
+		friend basic_iterator<!Const>;
+		using slot_pointer = std::conditional_t<Const, const Value *, Value *>;
+
+		const control * ctrl_ = nullptr;
+		const control * end_  = nullptr;
+		slot_pointer slot_    = nullptr;
+
+		basic_iterator(const control * ctrl, const control * end, slot_pointer slot) noexcept
+		: ctrl_(ctrl), end_(end), slot_(slot) {}
+
+		void skip_free() noexcept {
+			while (ctrl_ != end_ && *ctrl_ < 0) {
+				++ctrl_;
+				++slot_;
+			}
+		}
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type        = Value;
+		using difference_type   = std::ptrdiff_t;
+		using reference         = std::conditional_t<Const, const Value &, Value &>;
+		using pointer           = slot_pointer;
+
+		basic_iterator() = default;
+		template <bool OtherConst>
+			requires(Const && !OtherConst)
+		basic_iterator(const basic_iterator<OtherConst> & other) noexcept
+		: ctrl_(other.ctrl_), end_(other.end_), slot_(other.slot_) {}
+
+		[[nodiscard]] reference operator*() const noexcept { return *slot_; }
+		[[nodiscard]] pointer operator->() const noexcept { return slot_; }
+
+		basic_iterator & operator++() noexcept {
+			++ctrl_;
+			++slot_;
+			skip_free();
+			return *this;
+		}
+		basic_iterator operator++(int) noexcept {
+			auto result = *this;
+			++*this;
+			return result;
+		}
+
+		[[nodiscard]] friend bool operator==(const basic_iterator & lhs, const basic_iterator & rhs) noexcept {
+			return lhs.ctrl_ == rhs.ctrl_;
+		}
+	};
+
+public:
+	using key_type        = Key;
+	using value_type      = Value;
+	using size_type       = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using hasher          = Hash;
+	using key_equal       = KeyEqual;
+	using reference       = value_type &;
+	using const_reference = const value_type &;
+	using iterator        = basic_iterator<std::is_same_v<Key, Value>>;
+	using const_iterator  = basic_iterator<true>;
+
+private:
+	[[nodiscard]] static std::size_t control_bytes(std::size_t capacity) noexcept {
+		return (capacity + width + alignof(Value) - 1) & ~(alignof(Value) - 1);
+	}
+	[[nodiscard]] static std::size_t allocation_size(std::size_t capacity) noexcept {
+		return control_bytes(capacity) + capacity * sizeof(Value);
+	}
+
+	// control bytes and slots share one allocation, all slots are empty
+	void allocate(std::size_t capacity) {
+		auto * block = static_cast<unsigned char *>(
+			::operator new(allocation_size(capacity), std::align_val_t{ alignment }));
+		ctrl_        = reinterpret_cast<control *>(block);
+		slots_       = reinterpret_cast<Value *>(block + control_bytes(capacity));
+		capacity_    = capacity;
+		growth_left_ = max_load(capacity);
+		std::fill_n(ctrl_, capacity + width, ctrl_empty);
+	}
+	static void deallocate(control * ctrl, std::size_t capacity) noexcept {
+		if (ctrl)
+			::operator delete(ctrl, allocation_size(capacity), std::align_val_t{ alignment });
+	}
+
+	void destroy_slots() noexcept {
+		if constexpr (!std::is_trivially_destructible_v<Value>) {
+			for (std::size_t i = 0; i < capacity_; ++i)
+				if (ctrl_[i] >= 0)
+					std::destroy_at(slots_ + i);
+		}
+	}
+
+	// writes the slot's control byte and, for the first group, its mirror
+	void set_ctrl(std::size_t i, control c) noexcept {
+		ctrl_[i]                                       = c;
+		ctrl_[((i - width) & (capacity_ - 1)) + width] = c;
+	}
+
+	[[nodiscard]] std::size_t hash_of(const Key & key) const { return mix_hash(hash_(key)); }
+
+	template <typename F>
+	[[nodiscard]] std::size_t probe(std::size_t hash, F && f) const {
+		const std::size_t mask = capacity_ - 1;
+		std::size_t pos        = h1(hash) & mask;
+		for (std::size_t step = width;; step += width) {
+			if (const std::size_t i = f(probe_group{ ctrl_ + pos }, pos, mask); i != next_group)
+				return i;
+			pos = (pos + step) & mask;
+		}
+	}
+
+	[[nodiscard]] std::size_t find_free(std::size_t hash) const noexcept {
+		return probe(hash, [](const probe_group & group, std::size_t pos, std::size_t mask) {
+			const auto free = group.match_free();
+			return free ? (pos + lowest(free)) & mask : next_group;
+		});
+	}
+
+	// tombstones are cleared in place if at most half of the slots are taken, the capacity
+	// doubles otherwise
+	void grow() {
+		if (capacity_ != 0 && size_ <= capacity_ / 2)
+			rehash_to(capacity_);
+		else
+			rehash_to(capacity_ ? 2 * capacity_ : width);
+	}
+
+	// the new table is built on the side and swapped in once all values are in place. Values are
+	// relocated if neither that nor hashing them can throw. Otherwise they are copied, or moved if
+	// they can't be copied, and the originals are destroyed with the old table: an exception leaves
+	// the table as it was, holding moved-from values in the latter case.
+	void rehash_to(std::size_t capacity) {
+		constexpr bool relocate = noexcept(relocate_at(std::declval<Value *>(), std::declval<Value *>())) &&
+		                          noexcept(std::declval<const Hash &>()(std::declval<const Key &>()));
+		flat_table fresh(0, hash_, equal_);
+		fresh.allocate(capacity);
+		for (std::size_t i = 0; i < capacity_; ++i) {
+			if (ctrl_[i] >= 0) {
+				const std::size_t hash = hash_of(KeyOf{}(slots_[i]));
+				const std::size_t j    = fresh.find_free(hash);
+				if constexpr (relocate)
+					relocate_at(slots_ + i, fresh.slots_ + j);
+				else if constexpr (std::is_copy_constructible_v<Value>)
+					std::construct_at(fresh.slots_ + j, std::as_const(slots_[i]));
+				else
+					std::construct_at(fresh.slots_ + j, static_cast<Value &&>(slots_[i]));
+				fresh.set_ctrl(j, h2(hash));
+				++fresh.size_;
+			}
+		}
+		fresh.growth_left_ -= fresh.size_;
+		if constexpr (relocate) {
+			deallocate(std::exchange(ctrl_, nullptr), std::exchange(capacity_, 0));
+			size_ = 0;
+		}
+		swap(fresh);
+	}
+
+	[[nodiscard]] static std::size_t capacity_for(std::size_t n) noexcept {
+		std::size_t capacity = width;
+		while (max_load(capacity) < n)
+			capacity *= 2;
+		return capacity;
+	}
+
+protected:
+	[[nodiscard]] std::size_t find_index(const Key & key) const {
+		if (size_ == 0)
+			return not_found;
+		const std::size_t hash = hash_of(key);
+		const control tag      = h2(hash);
+		return probe(hash, [&](const probe_group & group, std::size_t pos, std::size_t mask) {
+			for (auto match = group.match(tag); match != 0; match &= match - 1) {
+				const std::size_t i = (pos + lowest(match)) & mask;
+				if (equal_(KeyOf{}(slots_[i]), key)) [[likely]]
+					return i;
+			}
+			// an empty slot ends every probe sequence which could have passed here
+			return group.match_empty() ? not_found : next_group;
+		});
+	}
+
+	[[nodiscard]] static constexpr bool found(std::size_t i) noexcept { return i < not_found; }
+
+	// the slot holding key, or a fresh one which make constructs the value into
+	template <typename Make>
+	std::pair<std::size_t, bool> find_or_insert(const Key & key, Make && make) {
+		if (const std::size_t i = find_index(key); found(i))
+			return { i, false };
+		if (growth_left_ == 0)
+			grow();
+		const std::size_t hash = hash_of(key);
+		const std::size_t i    = find_free(hash);
+		make(slots_ + i);
+		growth_left_ -= ctrl_[i] == ctrl_empty;
+		set_ctrl(i, h2(hash));
+		++size_;
+		return { i, true };
+	}
+
+	// a slot becomes empty again if no group around it was ever full, otherwise a tombstone
+	// keeps the probe sequences passing it intact
+	void erase_at(std::size_t i) noexcept {
+		std::destroy_at(slots_ + i);
+		--size_;
+		const std::size_t before = (i - width) & (capacity_ - 1);
+		const auto empty_after   = probe_group{ ctrl_ + i }.match_empty();
+		const auto empty_before  = probe_group{ ctrl_ + before }.match_empty();
+		if (empty_before && empty_after && lowest(empty_after) + probe_group::leading(empty_before) < width) {
+			set_ctrl(i, ctrl_empty);
+			++growth_left_;
+		} else {
+			set_ctrl(i, ctrl_deleted);
+		}
+	}
+
+	[[nodiscard]] Value & slot(std::size_t i) noexcept { return slots_[i]; }
+	[[nodiscard]] const Value & slot(std::size_t i) const noexcept { return slots_[i]; }
+
+	[[nodiscard]] iterator iterator_at(std::size_t i) noexcept {
+		return { ctrl_ + i, ctrl_ + capacity_, slots_ + i };
+	}
+	[[nodiscard]] const_iterator iterator_at(std::size_t i) const noexcept {
+		return { ctrl_ + i, ctrl_ + capacity_, slots_ + i };
+	}
+
+public:
+	flat_table() = default;
+	explicit flat_table(size_type n, const Hash & hash = Hash{}, const KeyEqual & equal = KeyEqual{})
+	: hash_(hash), equal_(equal) {
+		reserve(n);
+	}
+	// delegating, such that the destructor cleans up if a copy throws
+	flat_table(const flat_table & other) : flat_table(0, other.hash_, other.equal_) {
+		reserve(other.size_);
+		for (const auto & value : other) {
+			const std::size_t hash = hash_of(KeyOf{}(value));
+			const std::size_t i    = find_free(hash);
+			std::construct_at(slots_ + i, value);
+			set_ctrl(i, h2(hash));
+			++size_;
+			--growth_left_;
+		}
+	}
+	flat_table(flat_table && other) noexcept
+	: ctrl_(std::exchange(other.ctrl_, nullptr))
+	, slots_(std::exchange(other.slots_, nullptr))
+	, capacity_(std::exchange(other.capacity_, 0))
+	, size_(std::exchange(other.size_, 0))
+	, growth_left_(std::exchange(other.growth_left_, 0))
+	, hash_(other.hash_)
+	, equal_(other.equal_) {}
+	flat_table & operator=(flat_table other) noexcept {
+		swap(other);
+		return *this;
+	}
+	~flat_table() {
+		destroy_slots();
+		deallocate(ctrl_, capacity_);
+	}
+
+	void swap(flat_table & other) noexcept {
+		using std::swap;
+		swap(ctrl_, other.ctrl_);
+		swap(slots_, other.slots_);
+		swap(capacity_, other.capacity_);
+		swap(size_, other.size_);
+		swap(growth_left_, other.growth_left_);
+		swap(hash_, other.hash_);
+		swap(equal_, other.equal_);
+	}
+	friend void swap(flat_table & lhs, flat_table & rhs) noexcept { lhs.swap(rhs); }
+
+	[[nodiscard]] iterator begin() noexcept {
+		iterator it = iterator_at(0);
+		it.skip_free();
+		return it;
+	}
+	[[nodiscard]] const_iterator begin() const noexcept {
+		const_iterator it = iterator_at(0);
+		it.skip_free();
+		return it;
+	}
+	[[nodiscard]] iterator end() noexcept { return iterator_at(capacity_); }
+	[[nodiscard]] const_iterator end() const noexcept { return iterator_at(capacity_); }
+	[[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+	[[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+	[[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+	[[nodiscard]] size_type size() const noexcept { return size_; }
+	[[nodiscard]] size_type capacity() const noexcept { return capacity_; }
+	[[nodiscard]] float load_factor() const noexcept {
+		return capacity_ ? static_cast<float>(size_) / static_cast<float>(capacity_) : 0.0f;
+	}
+	[[nodiscard]] static constexpr float max_load_factor() noexcept { return 0.875f; }
+	[[nodiscard]] hasher hash_function() const { return hash_; }
+	[[nodiscard]] key_equal key_eq() const { return equal_; }
+
+	// room for n elements without rehashing
+	void reserve(size_type n) {
+		if (n > size_ + growth_left_)
+			rehash_to(capacity_for(n));
+	}
+
+	void clear() noexcept {
+		destroy_slots();
+		if (ctrl_)
+			std::fill_n(ctrl_, capacity_ + width, ctrl_empty);
+		size_        = 0;
+		growth_left_ = max_load(capacity_);
+	}
+
+	[[nodiscard]] iterator find(const Key & key) {
+		const std::size_t i = find_index(key);
+		return found(i) ? iterator_at(i) : end();
+	}
+	[[nodiscard]] const_iterator find(const Key & key) const {
+		const std::size_t i = find_index(key);
+		return found(i) ? iterator_at(i) : end();
+	}
+	[[nodiscard]] bool contains(const Key & key) const { return found(find_index(key)); }
+	[[nodiscard]] size_type count(const Key & key) const { return contains(key); }
+
+	size_type erase(const Key & key) {
+		const std::size_t i = find_index(key);
+		if (!found(i))
+			return 0;
+		erase_at(i);
+		return 1;
+	}
+	void erase(const_iterator pos) noexcept { erase_at(static_cast<std::size_t>(pos.ctrl_ - ctrl_)); }
+};
+
+} // non-exported namespace dtl
+} // anonymous namespace
+
+// an unordered map with open addressing: the values are stored inline, one control byte per
+// slot tells which slots are full. Lookups hand out optional<T &> with get and take values out
+// as optional<T> with extract. Rehashing relocates values, references and iterators are stable
+// until the next insertion.
+template <typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class flat_hash_map : public dtl::flat_table<std::pair<const Key, T>, Key, dtl::key_of_pair, Hash, KeyEqual> {
+	using base = dtl::flat_table<std::pair<const Key, T>, Key, dtl::key_of_pair, Hash, KeyEqual>;
+
+public:
+	using mapped_type    = T;
+	using value_type     = typename base::value_type;
+	using iterator       = typename base::iterator;
+	using const_iterator = typename base::const_iterator;
+
+	using base::base;
+
+	template <typename K, typename... Args>
+		requires std::is_same_v<std::remove_cvref_t<K>, Key>
+	std::pair<iterator, bool> try_emplace(K && key, Args &&... args) {
+		const auto [i, inserted] = this->find_or_insert(key, [&](value_type * slot) {
+			std::construct_at(slot, std::piecewise_construct, std::forward_as_tuple(static_cast<K &&>(key)),
+			                  std::forward_as_tuple(static_cast<Args &&>(args)...));
+		});
+		return { this->iterator_at(i), inserted };
+	}
+
+	std::pair<iterator, bool> insert(const value_type & value) { return try_emplace(value.first, value.second); }
+	std::pair<iterator, bool> insert(value_type && value) {
+		return try_emplace(value.first, static_cast<T &&>(value.second));
+	}
+
+	template <typename K, typename M>
+		requires std::is_same_v<std::remove_cvref_t<K>, Key> && std::is_assignable_v<T &, M>
+	std::pair<iterator, bool> insert_or_assign(K && key, M && obj) {
+		auto result = try_emplace(static_cast<K &&>(key), static_cast<M &&>(obj));
+		if (!result.second)
+			result.first->second = static_cast<M &&>(obj);
+		return result;
+	}
+
+	T & operator[](const Key & key) { return try_emplace(key).first->second; }
+	T & operator[](Key && key) { return try_emplace(static_cast<Key &&>(key)).first->second; }
+
+	[[nodiscard]] T & at(const Key & key) {
+		if (const auto i = this->find_index(key); base::found(i))
+			return this->slot(i).second;
+		throw std::out_of_range("flat_hash_map::at");
+	}
+	[[nodiscard]] const T & at(const Key & key) const {
+		if (const auto i = this->find_index(key); base::found(i))
+			return this->slot(i).second;
+		throw std::out_of_range("flat_hash_map::at");
+	}
+
+	// the mapped value, if any
+	[[nodiscard]] optional<T &> get(const Key & key) {
+		if (const auto i = this->find_index(key); base::found(i))
+			return this->slot(i).second;
+		return none;
+	}
+	[[nodiscard]] optional<const T &> get(const Key & key) const {
+		if (const auto i = this->find_index(key); base::found(i))
+			return this->slot(i).second;
+		return none;
+	}
+
+	// erases the element and returns its mapped value, if any
+	optional<T> extract(const Key & key) {
+		optional<T> result;
+		if (const auto i = this->find_index(key); base::found(i)) {
+			result.emplace(static_cast<T &&>(this->slot(i).second));
+			this->erase_at(i);
+		}
+		return result;
+	}
+};
+
+// the set flavour of flat_hash_map, its elements are immutable
+template <typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class flat_hash_set : public dtl::flat_table<Key, Key, dtl::key_of_self, Hash, KeyEqual> {
+	using base = dtl::flat_table<Key, Key, dtl::key_of_self, Hash, KeyEqual>;
+
+public:
+	using value_type = Key;
+	using iterator   = typename base::iterator;
+
+	using base::base;
+
+	std::pair<iterator, bool> insert(const Key & key) {
+		const auto [i, inserted] = this->find_or_insert(key, [&](Key * slot) { std::construct_at(slot, key); });
+		return { this->iterator_at(i), inserted };
+	}
+	std::pair<iterator, bool> insert(Key && key) {
+		const auto [i, inserted] =
+			this->find_or_insert(key, [&](Key * slot) { std::construct_at(slot, static_cast<Key &&>(key)); });
+		return { this->iterator_at(i), inserted };
+	}
+	template <typename... Args>
+	std::pair<iterator, bool> emplace(Args &&... args) {
+		return insert(Key(static_cast<Args &&>(args)...));
+	}
+
+	// the element equal to key, if any
+	[[nodiscard]] optional<const Key &> get(const Key & key) const {
+		if (const auto i = this->find_index(key); base::found(i))
+			return this->slot(i);
+		return none;
+	}
+
+	// erases the element equal to key and returns it, if any
+	optional<Key> extract(const Key & key) {
+		optional<Key> result;
+		if (const auto i = this->find_index(key); base::found(i)) {
+			result.emplace(static_cast<Key &&>(this->slot(i)));
+			this->erase_at(i);
+		}
+		return result;
+	}
+};
+
+} // namespace OPTIONAL_NAMESPACE
+
+#undef OPTIONAL_SIMD_SSE2
+#undef OPTIONAL_NAMESPACE
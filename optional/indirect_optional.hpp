@@ -0,0 +1,556 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#pragma push_macro("OPTIONAL_NAMESPACE")
+#include "optional.hpp"
+#pragma pop_macro("OPTIONAL_NAMESPACE")
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifndef OPTIONAL_NAMESPACE
+#define OPTIONAL_NAMESPACE boost
+#endif
+
+namespace OPTIONAL_NAMESPACE {
+namespace {
+namespace dtl {
+
+// free lists of blocks of one size and alignment. The blocks are carved from chunks which are
+// never handed back to the system, a block freed by one thread is reused by any other. Every
+// thread keeps a list of its own, the list shared by all threads is locked only when a thread runs
+// dry, hoards too many blocks, or exits.
+template <std::size_t Size, std::size_t Align>
+class block_pool {
+	struct block {
+		block * next;
+	};
+	struct chunk {
+		chunk * next;
+	};
+
+	static constexpr std::size_t block_align  = std::max(Align, alignof(block));
+	static constexpr std::size_t block_size   = (std::max(Size, sizeof(block)) + block_align - 1) / block_align * block_align;
+	static constexpr std::size_t chunk_blocks = std::max<std::size_t>(16, 64 * 1024 / block_size);
+	static constexpr std::size_t cache_limit  = 2 * chunk_blocks;
+
+	struct list {
+		block * head      = nullptr;
+		block * tail      = nullptr;
+		std::size_t count = 0;
+
+		void push(block * b) noexcept {
+			b->next = head;
+			if (!head)
+				tail = b;
+			head = b;
+			++count;
+		}
+		[[nodiscard]] block * pop() noexcept {
+			block * b = head;
+			head      = b->next;
+			--count;
+			return b;
+		}
+		void splice(list & other) noexcept {
+			if (!other.head)
+				return;
+			other.tail->next = head;
+			if (!head)
+				tail = other.tail;
+			head  = other.head;
+			count += other.count;
+			other = list{};
+		}
+	};
+
+	struct shared {
+		std::mutex mutex;
+		list free;
+		chunk * chunks = nullptr;
+	};
+	// never destroyed: blocks are still returned by thread exits and static destructors
+	[[nodiscard]] static shared & global() {
+		static shared * const s = new shared;
+		return *s;
+	}
+
+	struct cache : list {
+		~cache() {
+			shared & s = global();
+			const std::lock_guard lock(s.mutex);
+			s.free.splice(*this);
+		}
+	};
+	[[nodiscard]] static list & local() noexcept {
+		thread_local cache c;
+		return c;
+	}
+
+	static void refill(list & l) {
+		shared & s = global();
+		{
+			const std::lock_guard lock(s.mutex);
+			if (s.free.head) {
+				l.splice(s.free);
+				return;
+			}
+		}
+		// the first block of a chunk links it to the others
+		auto * const memory = static_cast<std::byte *>(
+			::operator new((chunk_blocks + 1) * block_size, std::align_val_t{ block_align }));
+		for (std::size_t i = chunk_blocks; i > 0; --i)
+			l.push(::new (memory + i * block_size) block{});
+		const std::lock_guard lock(s.mutex);
+		s.chunks = ::new (memory) chunk{ s.chunks };
+	}
+
+	static void flush(list & l) noexcept {
+		shared & s = global();
+		const std::lock_guard lock(s.mutex);
+		s.free.splice(l);
+	}
+
+public:
+	[[nodiscard]] static void * allocate() {
+		list & l = local();
+		if (!l.head) [[unlikely]]
+			refill(l);
+		return l.pop();
+	}
+
+	static void deallocate(void * p) noexcept {
+		list & l = local();
+		l.push(::new (p) block{});
+		if (l.count > cache_limit) [[unlikely]]
+			flush(l);
+	}
+};
+
+} // non-exported namespace dtl
+} // anonymous namespace
+
+// an allocator handing out single objects from a pool of equally sized blocks, shared by all
+// pool_allocators of the same object size and alignment. Arrays come from std::allocator.
+template <typename T>
+struct pool_allocator {
+	using value_type      = T;
+	using is_always_equal = std::true_type;
+
+	[[nodiscard]] constexpr pool_allocator() noexcept = default;
+	template <typename U>
+	[[nodiscard]] constexpr pool_allocator(const pool_allocator<U> &) noexcept {}
+
+	[[nodiscard]] T * allocate(std::size_t n) {
+		if (n == 1) [[likely]]
+			return static_cast<T *>(dtl::block_pool<sizeof(T), alignof(T)>::allocate());
+		return std::allocator<T>{}.allocate(n);
+	}
+	void deallocate(T * p, std::size_t n) noexcept {
+		if (n == 1) [[likely]]
+			dtl::block_pool<sizeof(T), alignof(T)>::deallocate(p);
+		else
+			std::allocator<T>{}.deallocate(p, n);
+	}
+
+	template <typename U>
+	[[nodiscard]] constexpr bool operator==(const pool_allocator<U> &) const noexcept {
+		return true;
+	}
+};
+
+// an optional<T> keeping its payload out of line: a disengaged indirect_optional is a null
+// pointer, so records with large, rarely engaged members stay small. The payload lives in storage
+// from Allocator, a pool_allocator by default which makes engagement about as cheap as a pointer
+// bump. Copies are deep, moves steal the payload and leave the source disengaged.
+template <typename T, typename Allocator = pool_allocator<T>>
+	requires (std::is_object_v<T> && !std::is_array_v<T> && !std::is_const_v<T> &&
+	          std::is_same_v<typename std::allocator_traits<Allocator>::value_type, T>)
+class indirect_optional {
+	using traits = std::allocator_traits<Allocator>;
+
+	T * p_ = nullptr;
+	[[no_unique_address]] Allocator a_;
+
+	template <typename... Args>
+	[[nodiscard]] T * make(Args &&... args) {
+		T * const p = traits::allocate(a_, 1);
+		try {
+			traits::construct(a_, p, static_cast<Args &&>(args)...);
+		} catch (...) {
+			traits::deallocate(a_, p, 1);
+			throw;
+		}
+		return p;
+	}
+
+	template <typename U>
+	void assign(U && value) {
+		if (p_)
+			*p_ = static_cast<U &&>(value);
+		else
+			p_ = make(static_cast<U &&>(value));
+	}
+
+public:
+	using value_type     = T;
+	using allocator_type = Allocator;
+
+	// construction
+	[[nodiscard]] indirect_optional() noexcept(std::is_nothrow_default_constructible_v<Allocator>) = default;
+	[[nodiscard]] indirect_optional(std::nullopt_t) noexcept(std::is_nothrow_default_constructible_v<Allocator>) {}
+	[[nodiscard]] explicit indirect_optional(const Allocator & a) noexcept : a_(a) {}
+
+	template <typename U = T>
+		requires (std::is_constructible_v<T, U> && !dtl::optional_related<U> &&
+		          !std::is_same_v<std::remove_cvref_t<U>, indirect_optional>)
+	[[nodiscard]] indirect_optional(U && value) : p_(make(static_cast<U &&>(value))) {}
+
+	template <typename... Args>
+		requires std::is_constructible_v<T, Args...>
+	[[nodiscard]] explicit indirect_optional(std::in_place_t, Args &&... args)
+	: p_(make(static_cast<Args &&>(args)...)) {}
+
+	[[nodiscard]] indirect_optional(bool condition, const T & value) {
+		if (condition)
+			p_ = make(value);
+	}
+
+	[[nodiscard]] indirect_optional(const optional<T> & other) {
+		if (other)
+			p_ = make(*other);
+	}
+	[[nodiscard]] indirect_optional(optional<T> && other) {
+		if (other)
+			p_ = make(static_cast<T &&>(*other));
+	}
+
+	[[nodiscard]] indirect_optional(const indirect_optional & other)
+	: a_(traits::select_on_container_copy_construction(other.a_)) {
+		if (other.p_)
+			p_ = make(*other.p_);
+	}
+	[[nodiscard]] indirect_optional(indirect_optional && other) noexcept
+	: p_(std::exchange(other.p_, nullptr))
+	, a_(static_cast<Allocator &&>(other.a_)) {}
+
+	~indirect_optional() { reset(); }
+
+	// assignment
+	indirect_optional & operator=(std::nullopt_t) noexcept {
+		reset();
+		return *this;
+	}
+
+	indirect_optional & operator=(const indirect_optional & other) {
+		if (this == &other)
+			return *this;
+		if constexpr (traits::propagate_on_container_copy_assignment::value) {
+			if (!traits::is_always_equal::value && a_ != other.a_)
+				reset();
+			a_ = other.a_;
+		}
+		if (other.p_)
+			assign(*other.p_);
+		else
+			reset();
+		return *this;
+	}
+
+	indirect_optional & operator=(indirect_optional && other) noexcept(
+		traits::propagate_on_container_move_assignment::value || traits::is_always_equal::value) {
+		if (this == &other)
+			return *this;
+		if constexpr (traits::propagate_on_container_move_assignment::value) {
+			reset();
+			a_ = static_cast<Allocator &&>(other.a_);
+		} else if (!traits::is_always_equal::value && a_ != other.a_) {
+			// the payload can't change hands, it is moved instead
+			if (other.p_) {
+				assign(static_cast<T &&>(*other.p_));
+				other.reset();
+			} else {
+				reset();
+			}
+			return *this;
+		} else {
+			reset();
+		}
+		p_ = std::exchange(other.p_, nullptr);
+		return *this;
+	}
+
+	template <typename U = T>
+		requires (std::is_constructible_v<T, U> && std::is_assignable_v<T &, U> && !dtl::optional_related<U> &&
+		          !std::is_same_v<std::remove_cvref_t<U>, indirect_optional>)
+	indirect_optional & operator=(U && value) {
+		assign(static_cast<U &&>(value));
+		return *this;
+	}
+
+	indirect_optional & operator=(const optional<T> & other) {
+		if (other)
+			assign(*other);
+		else
+			reset();
+		return *this;
+	}
+	indirect_optional & operator=(optional<T> && other) {
+		if (other)
+			assign(static_cast<T &&>(*other));
+		else
+			reset();
+		return *this;
+	}
+
+	// modifiers
+	template <typename... Args>
+		requires std::is_constructible_v<T, Args...>
+	T & emplace(Args &&... args) {
+		reset();
+		p_ = make(static_cast<Args &&>(args)...);
+		return *p_;
+	}
+
+	void reset() noexcept {
+		if (p_) {
+			traits::destroy(a_, p_);
+			traits::deallocate(a_, std::exchange(p_, nullptr), 1);
+		}
+	}
+
+	void swap(indirect_optional & other) noexcept {
+		using std::swap;
+		if constexpr (traits::propagate_on_container_swap::value)
+			swap(a_, other.a_);
+		swap(p_, other.p_);
+	}
+	friend void swap(indirect_optional & lhs, indirect_optional & rhs) noexcept { lhs.swap(rhs); }
+
+	// observers
+	[[nodiscard]] bool has_value() const noexcept { return p_ != nullptr; }
+	[[nodiscard]] explicit operator bool() const noexcept { return p_ != nullptr; }
+	[[nodiscard]] bool operator!() const noexcept { return p_ == nullptr; }
+
+	[[nodiscard]] const T & operator*() const & noexcept { return *p_; }
+	[[nodiscard]] T & operator*() & noexcept { return *p_; }
+	[[nodiscard]] T && operator*() && noexcept { return static_cast<T &&>(*p_); }
+	[[nodiscard]] const T * operator->() const noexcept { return p_; }
+	[[nodiscard]] T * operator->() noexcept { return p_; }
+
+	[[nodiscard]] const T & get() const noexcept { return *p_; }
+	[[nodiscard]] T & get() noexcept { return *p_; }
+
+	[[nodiscard]] const T * get_ptr() const noexcept { return p_; }
+	[[nodiscard]] T * get_ptr() noexcept { return p_; }
+
+	[[nodiscard]] allocator_type get_allocator() const noexcept { return a_; }
+
+	[[nodiscard]] const T & value() const & {
+		if (!p_)
+			throw bad_optional_access{};
+		return *p_;
+	}
+	[[nodiscard]] T & value() & {
+		if (!p_)
+			throw bad_optional_access{};
+		return *p_;
+	}
+	[[nodiscard]] T && value() && {
+		if (!p_)
+			throw bad_optional_access{};
+		return static_cast<T &&>(*p_);
+	}
+
+	template <typename U>
+	[[nodiscard]] T value_or(U && replacement) const & {
+		return p_ ? *p_ : static_cast<T>(static_cast<U &&>(replacement));
+	}
+	template <typename U>
+	[[nodiscard]] T value_or(U && replacement) && {
+		return p_ ? static_cast<T &&>(*p_) : static_cast<T>(static_cast<U &&>(replacement));
+	}
+
+	[[nodiscard]] const T & get_value_or(const T & replacement) const noexcept { return p_ ? *p_ : replacement; }
+	[[nodiscard]] T & get_value_or(T & replacement) noexcept { return p_ ? *p_ : replacement; }
+
+	template <typename Func>
+	[[nodiscard]] T value_or_eval(Func f) const & {
+		return p_ ? *p_ : f();
+	}
+	template <typename Func>
+	[[nodiscard]] T value_or_eval(Func f) && {
+		return p_ ? static_cast<T &&>(*p_) : f();
+	}
+
+	template <typename Func>
+	[[nodiscard]] optional<std::invoke_result_t<Func, T &>> map(Func f) & {
+		if (p_)
+			return f(*p_);
+		return none;
+	}
+	template <typename Func>
+	[[nodiscard]] optional<std::invoke_result_t<Func, const T &>> map(Func f) const & {
+		if (p_)
+			return f(*p_);
+		return none;
+	}
+	template <typename Func>
+	[[nodiscard]] optional<std::invoke_result_t<Func, T &&>> map(Func f) && {
+		if (p_)
+			return f(static_cast<T &&>(*p_));
+		return none;
+	}
+
+	template <typename Func>
+	[[nodiscard]] optional<dtl::unwrap_t<std::invoke_result_t<Func, T &>>> flat_map(Func f) & {
+		if (p_)
+			return f(*p_);
+		return none;
+	}
+	template <typename Func>
+	[[nodiscard]] optional<dtl::unwrap_t<std::invoke_result_t<Func, const T &>>> flat_map(Func f) const & {
+		if (p_)
+			return f(*p_);
+		return none;
+	}
+	template <typename Func>
+	[[nodiscard]] optional<dtl::unwrap_t<std::invoke_result_t<Func, T &&>>> flat_map(Func f) && {
+		if (p_)
+			return f(static_cast<T &&>(*p_));
+		return none;
+	}
+
+	// views of the payload, and copies into an inline optional
+	[[nodiscard]] optional<const T &> as_optional() const noexcept {
+		if (p_)
+			return *p_;
+		return none;
+	}
+	[[nodiscard]] optional<T &> as_optional() noexcept {
+		if (p_)
+			return *p_;
+		return none;
+	}
+
+	[[nodiscard]] operator optional<T>() const & {
+		if (p_)
+			return *p_;
+		return none;
+	}
+	[[nodiscard]] operator optional<T>() && {
+		if (p_)
+			return static_cast<T &&>(*p_);
+		return none;
+	}
+}; // class indirect_optional
+
+template <typename T>
+indirect_optional(T) -> indirect_optional<T>;
+
+template <typename T, typename... Args>
+[[nodiscard]] indirect_optional<T> make_indirect_optional(Args &&... args) {
+	return indirect_optional<T>(std::in_place, static_cast<Args &&>(args)...);
+}
+
+namespace {
+namespace dtl {
+
+template <typename T>
+struct is_indirect_optional : std::false_type {};
+template <typename T, typename A>
+struct is_indirect_optional<indirect_optional<T, A>> : std::true_type {};
+
+template <typename T>
+concept indirect_type = is_indirect_optional<std::remove_cvref_t<T>>::value;
+
+template <typename T>
+concept indirect_related = indirect_type<T> || optional_related<T>;
+
+} // non-exported namespace dtl
+} // anonymous namespace
+
+// relational operators as of the optional<const T &> views, ordered like optional<T>: a
+// disengaged indirect_optional is less than any engaged one. The compiler rewrites !=, <, >, <=
+// and >= from == and <=>.
+template <typename T, typename A, typename U, typename B>
+[[nodiscard]] bool operator==(const indirect_optional<T, A> & lhs, const indirect_optional<U, B> & rhs) {
+	return lhs.as_optional() == rhs.as_optional();
+}
+template <typename T, typename A, typename U, typename B>
+	requires dtl::synth_comparable<T, U>
+[[nodiscard]] dtl::synth_three_way_t<T, U> operator<=>(const indirect_optional<T, A> & lhs,
+                                                        const indirect_optional<U, B> & rhs) {
+	return lhs && rhs ? dtl::synth_three_way(*lhs, *rhs) : lhs.has_value() <=> rhs.has_value();
+}
+
+// with optional<U> in both operand orders: else the comparisons of optional<U> with a payload
+// would take the indirect_optional for one
+template <typename T, typename A, typename U>
+[[nodiscard]] bool operator==(const indirect_optional<T, A> & lhs, const optional<U> & rhs) {
+	return lhs.as_optional() == rhs;
+}
+template <typename T, typename U, typename B>
+[[nodiscard]] bool operator==(const optional<T> & lhs, const indirect_optional<U, B> & rhs) {
+	return lhs == rhs.as_optional();
+}
+template <typename T, typename A, typename U>
+	requires dtl::synth_comparable<T, U>
+[[nodiscard]] dtl::synth_three_way_t<T, U> operator<=>(const indirect_optional<T, A> & lhs, const optional<U> & rhs) {
+	return lhs && rhs ? dtl::synth_three_way(*lhs, *rhs) : lhs.has_value() <=> rhs.has_value();
+}
+template <typename T, typename U, typename B>
+	requires dtl::synth_comparable<T, U>
+[[nodiscard]] dtl::synth_three_way_t<T, U> operator<=>(const optional<T> & lhs, const indirect_optional<U, B> & rhs) {
+	return lhs && rhs ? dtl::synth_three_way(*lhs, *rhs) : lhs.has_value() <=> rhs.has_value();
+}
+
+template <typename T, typename A>
+[[nodiscard]] bool operator==(const indirect_optional<T, A> & o, std::nullopt_t) noexcept {
+	return !o.has_value();
+}
+template <typename T, typename A>
+[[nodiscard]] std::strong_ordering operator<=>(const indirect_optional<T, A> & o, std::nullopt_t) noexcept {
+	return o.has_value() <=> false;
+}
+
+template <typename T, typename A, typename U>
+	requires (!dtl::indirect_related<U>) && dtl::eq_comparable<T, U>
+[[nodiscard]] bool operator==(const indirect_optional<T, A> & lhs, const U & rhs) {
+	return lhs.has_value() && static_cast<bool>(*lhs == rhs);
+}
+template <typename T, typename A, typename U>
+	requires (!dtl::indirect_related<U>) && dtl::synth_comparable<T, U>
+[[nodiscard]] dtl::synth_three_way_t<T, U> operator<=>(const indirect_optional<T, A> & lhs, const U & rhs) {
+	return lhs.has_value() ? dtl::synth_three_way(*lhs, rhs) : std::strong_ordering::less;
+}
+
+} // namespace OPTIONAL_NAMESPACE
+
+// hashes like the optional<const T &> view
+namespace std {
+
+template <typename T, typename A>
+	requires is_default_constructible_v<hash<::OPTIONAL_NAMESPACE::optional<const T &>>>
+struct hash<::OPTIONAL_NAMESPACE::indirect_optional<T, A>> {
+	[[nodiscard]] size_t operator()(const ::OPTIONAL_NAMESPACE::indirect_optional<T, A> & o) const
+		noexcept(noexcept(hash<::OPTIONAL_NAMESPACE::optional<const T &>>{}(o.as_optional()))) {
+		return hash<::OPTIONAL_NAMESPACE::optional<const T &>>{}(o.as_optional());
+	}
+};
+
+} // namespace std
+
+#undef OPTIONAL_NAMESPACE
@@ -0,0 +1,173 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#pragma push_macro("OPTIONAL_NAMESPACE")
+#include "optional.hpp"
+#pragma pop_macro("OPTIONAL_NAMESPACE")
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+#ifndef OPTIONAL_NAMESPACE
+#define OPTIONAL_NAMESPACE boost
+#endif
+
+namespace OPTIONAL_NAMESPACE {
+namespace {
+namespace dtl {
+
+template <typename F, typename T>
+concept lazy_source = inplace_factory_type<F> || (std::is_invocable_v<F> && result_convertible<F, T>);
+
+} // non-exported namespace dtl
+} // anonymous namespace
+
+// an optional<T> whose value is computed on first observation: it holds either nothing, a pending
+// computation F, or the value. F is a callable returning T, or an in-place factory. Observers
+// materialize the value and cache it, the pending computation is discarded then. Should F throw,
+// it stays pending and is retried on the next observation. has_value() and operator bool don't
+// materialize. Unlike once_optional, a lazy_optional must not be observed concurrently.
+template <typename T, typename F = std::function<T()>>
+	requires (std::is_object_v<T> && !std::is_const_v<T> && dtl::lazy_source<F, T>)
+class lazy_optional {
+	mutable optional<T> value_;
+	mutable optional<F> pending_;
+
+	T & materialize() const {
+		if (pending_) {
+			if constexpr (dtl::inplace_factory_type<F>)
+				value_ = static_cast<F &&>(*pending_);
+			else
+				value_.emplace_from(static_cast<F &&>(*pending_));
+			pending_.reset();
+		}
+		return *value_;
+	}
+
+public:
+	using value_type = T;
+
+	// construction
+	[[nodiscard]] constexpr lazy_optional() noexcept = default;
+	[[nodiscard]] constexpr lazy_optional(std::nullopt_t) noexcept {}
+
+	template <typename G>
+		requires (std::is_constructible_v<F, G> && !dtl::optional_related<G> &&
+		          !std::is_same_v<std::remove_cvref_t<G>, lazy_optional>)
+	[[nodiscard]] constexpr lazy_optional(G && f) : pending_(std::in_place, static_cast<G &&>(f)) {}
+
+	// an already computed value
+	[[nodiscard]] constexpr lazy_optional(const optional<T> & value) : value_(value) {}
+	[[nodiscard]] constexpr lazy_optional(optional<T> && value) : value_(static_cast<optional<T> &&>(value)) {}
+
+	// assignment
+	constexpr lazy_optional & operator=(std::nullopt_t) noexcept {
+		value_.reset();
+		pending_.reset();
+		return *this;
+	}
+	template <typename G>
+		requires (std::is_constructible_v<F, G> && !dtl::optional_related<G> &&
+		          !std::is_same_v<std::remove_cvref_t<G>, lazy_optional>)
+	constexpr lazy_optional & operator=(G && f) {
+		pending_.emplace(static_cast<G &&>(f));
+		value_.reset();
+		return *this;
+	}
+
+	// observers which don't materialize
+	[[nodiscard]] constexpr bool has_value() const noexcept { return value_.has_value() || pending_.has_value(); }
+	[[nodiscard]] constexpr explicit operator bool() const noexcept { return has_value(); }
+	[[nodiscard]] constexpr bool operator!() const noexcept { return !has_value(); }
+	[[nodiscard]] constexpr bool is_materialized() const noexcept { return value_.has_value(); }
+
+	// observers which materialize
+	[[nodiscard]] const T & operator*() const { return materialize(); }
+	[[nodiscard]] T & operator*() { return materialize(); }
+	[[nodiscard]] const T * operator->() const { return std::addressof(materialize()); }
+	[[nodiscard]] T * operator->() { return std::addressof(materialize()); }
+
+	[[nodiscard]] const T & get() const { return materialize(); }
+	[[nodiscard]] T & get() { return materialize(); }
+
+	[[nodiscard]] const T * get_ptr() const { return has_value() ? std::addressof(materialize()) : nullptr; }
+	[[nodiscard]] T * get_ptr() { return has_value() ? std::addressof(materialize()) : nullptr; }
+
+	[[nodiscard]] const T & value() const {
+		if (!has_value())
+			throw bad_optional_access{};
+		return materialize();
+	}
+	[[nodiscard]] T & value() {
+		if (!has_value())
+			throw bad_optional_access{};
+		return materialize();
+	}
+
+	template <typename U>
+	[[nodiscard]] T value_or(U && replacement) const {
+		return has_value() ? materialize() : static_cast<T>(static_cast<U &&>(replacement));
+	}
+
+	template <typename Func>
+	[[nodiscard]] T value_or_eval(Func f) const {
+		return has_value() ? materialize() : f();
+	}
+
+	template <typename Func>
+	[[nodiscard]] optional<std::invoke_result_t<Func, const T &>> map(Func f) const {
+		if (has_value())
+			return f(materialize());
+		return none;
+	}
+
+	template <typename Func>
+	[[nodiscard]] optional<dtl::unwrap_t<std::invoke_result_t<Func, const T &>>> flat_map(Func f) const {
+		if (has_value())
+			return f(materialize());
+		return none;
+	}
+
+	// conversion to optional, materializes
+	[[nodiscard]] operator optional<T>() const & {
+		if (has_value())
+			return materialize();
+		return none;
+	}
+	[[nodiscard]] operator optional<T>() && {
+		if (has_value())
+			return static_cast<T &&>(materialize());
+		return none;
+	}
+
+	// modifiers
+	constexpr void reset() noexcept {
+		value_.reset();
+		pending_.reset();
+	}
+}; // class lazy_optional
+
+template <typename F>
+	requires (std::is_invocable_v<F> && !dtl::optional_related<F>)
+lazy_optional(F) -> lazy_optional<std::remove_cvref_t<std::invoke_result_t<F>>, F>;
+
+template <typename T, typename F>
+[[nodiscard]] constexpr lazy_optional<T, std::decay_t<F>> make_lazy_optional(F && f) {
+	return lazy_optional<T, std::decay_t<F>>(static_cast<F &&>(f));
+}
+
+template <typename F>
+	requires std::is_invocable_v<F>
+[[nodiscard]] constexpr auto make_lazy_optional(F && f) {
+	return lazy_optional(std::decay_t<F>(static_cast<F &&>(f)));
+}
+
+} // namespace OPTIONAL_NAMESPACE
+
+#undef OPTIONAL_NAMESPACE
@@ -0,0 +1,113 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#pragma push_macro("OPTIONAL_NAMESPACE")
+#include "optional.hpp"
+#pragma pop_macro("OPTIONAL_NAMESPACE")
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+#ifndef OPTIONAL_NAMESPACE
+#define OPTIONAL_NAMESPACE boost
+#endif
+
+namespace OPTIONAL_NAMESPACE {
+
+// an optional<T> which is computed at most once, on first access through value_or_eval. Threads
+// arriving while the value is being computed block until it's ready; once it is, accessing it
+// costs a single acquire load. Should the computation throw, the next caller retries.
+// reset() discards the value for it to be computed again on next access. It may run concurrently
+// with value_or_eval, but not while other threads still refer to the value.
+template <typename T>
+	requires (std::is_object_v<T> && !std::is_const_v<T>)
+class once_optional {
+	enum state : unsigned char { empty, busy, ready };
+
+	mutable std::atomic<state> state_{ empty };
+	mutable optional<T> value_;
+
+	// takes the state from 'from' to busy, waiting for a competing thread to finish its work
+	[[nodiscard]] bool acquire(state from) const noexcept {
+		for (state s = state_.load(std::memory_order_acquire);;) {
+			if (s == busy) {
+				state_.wait(busy, std::memory_order_acquire);
+				s = state_.load(std::memory_order_acquire);
+			} else if (s != from) {
+				return false;
+			} else if (state_.compare_exchange_weak(s, busy, std::memory_order_acquire)) {
+				return true;
+			}
+		}
+	}
+	void release(state to) const noexcept {
+		state_.store(to, std::memory_order_release);
+		state_.notify_all();
+	}
+
+public:
+	using value_type = T;
+
+	constexpr once_optional() noexcept = default;
+	once_optional(const once_optional &) = delete;
+	once_optional & operator=(const once_optional &) = delete;
+
+	// observers
+	[[nodiscard]] bool has_value() const noexcept { return state_.load(std::memory_order_acquire) == ready; }
+	[[nodiscard]] explicit operator bool() const noexcept { return has_value(); }
+	[[nodiscard]] bool operator!() const noexcept { return !has_value(); }
+
+	[[nodiscard]] const T * get_ptr() const noexcept {
+		return has_value() ? std::addressof(*value_) : nullptr;
+	}
+	[[nodiscard]] const T & get() const noexcept { return *value_; }
+	[[nodiscard]] const T & operator*() const noexcept { return *value_; }
+	[[nodiscard]] const T * operator->() const noexcept { return std::addressof(*value_); }
+
+	template <typename Func>
+	[[nodiscard]] optional<std::invoke_result_t<Func, const T &>> map(Func f) const {
+		if (has_value())
+			return f(*value_);
+		return none;
+	}
+
+	// the value, computed from f() by the first caller only
+	template <typename Func>
+		requires dtl::result_convertible<Func, T>
+	const T & value_or_eval(Func && f) const {
+		if (state_.load(std::memory_order_acquire) == ready)
+			return *value_;
+		if (acquire(empty)) {
+			struct rollback {
+				const once_optional * self;
+				~rollback() {
+					if (self)
+						self->release(empty);
+				}
+			} guard{ this };
+			value_.emplace_from(static_cast<Func &&>(f));
+			guard.self = nullptr;
+			release(ready);
+		}
+		return *value_;
+	}
+
+	// modifiers
+	void reset() noexcept {
+		if (acquire(ready)) {
+			value_.reset();
+			release(empty);
+		}
+	}
+}; // class once_optional
+
+} // namespace OPTIONAL_NAMESPACE
+
+#undef OPTIONAL_NAMESPACE
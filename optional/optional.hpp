@@ -32,6 +32,16 @@
 #include <functional> // for std::hash
 #include <concepts>
 #include <compare>
+#include <bit>     // for std::bit_cast
+#include <memory>  // for uses-allocator construction
+#include <new>     // for std::launder
+#include <cstdint>
+#ifdef OPTIONAL_TELEMETRY
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <source_location>
+#endif
 
 namespace boost {
 class in_place_factory_base;
@@ -100,6 +110,132 @@ inline constexpr nullopt_t nullopt{ std::nullopt };
 // [optional.bad.access]
 using bad_optional_access = std::bad_optional_access;
 
+#ifdef OPTIONAL_TELEMETRY
+// opt-in instrumentation, compiled in by defining OPTIONAL_TELEMETRY: counters per payload type T
+// of optional<T>, created on first use. Copies and moves of optional<T> itself aren't counted,
+// they remain trivial where the payload's are.
+struct optional_telemetry {
+	using counter = std::atomic<std::uint64_t>;
+
+	const char * type; // the signature of telemetry<T>()
+	counter engaged{ 0 };           // constructed engaged
+	counter disengaged{ 0 };        // constructed disengaged
+	counter bad_access{ 0 };        // value() threw bad_optional_access
+	counter factory{ 0 };           // payloads made by in-place factories
+	counter replace{ 0 };           // payloads rebuilt in place by factory assignment
+	counter converting_copies{ 0 }; // payloads copied by converting constructors
+	counter converting_moves{ 0 };  // payloads moved by converting constructors
+	optional_telemetry * next = nullptr;
+
+	static inline std::atomic<optional_telemetry *> all{ nullptr };
+
+	explicit optional_telemetry(const char * name) noexcept : type(name), next(all.load()) {
+		while (!all.compare_exchange_weak(next, this))
+			;
+	}
+};
+
+template <typename T>
+[[nodiscard]] optional_telemetry & telemetry() noexcept {
+	static optional_telemetry counters{ std::source_location::current().function_name() };
+	return counters;
+}
+
+// calls f(const optional_telemetry &) for the counters of every payload type seen so far
+template <typename Func>
+void for_each_telemetry(Func f) {
+	for (const optional_telemetry * t = optional_telemetry::all.load(); t; t = t->next)
+		f(*t);
+}
+
+inline void dump_telemetry(std::FILE * out = stderr) {
+	std::fprintf(out, "%12s %12s %12s %12s %12s %12s %12s  type\n", "engaged", "disengaged", "bad_access",
+	             "factory", "replace", "conv_copies", "conv_moves");
+	for_each_telemetry([out](const optional_telemetry & t) {
+		std::fprintf(out, "%12llu %12llu %12llu %12llu %12llu %12llu %12llu  %s\n",
+		             static_cast<unsigned long long>(t.engaged.load()),
+		             static_cast<unsigned long long>(t.disengaged.load()),
+		             static_cast<unsigned long long>(t.bad_access.load()),
+		             static_cast<unsigned long long>(t.factory.load()),
+		             static_cast<unsigned long long>(t.replace.load()),
+		             static_cast<unsigned long long>(t.converting_copies.load()),
+		             static_cast<unsigned long long>(t.converting_moves.load()), t.type);
+	});
+}
+
+// dumps the counters to stderr at program exit
+inline void dump_telemetry_at_exit() {
+	static const int registered = std::atexit([] { dump_telemetry(); });
+	static_cast<void>(registered);
+}
+#endif
+
+// [optional.niche]
+// customization point: specialize optional_niche<T> with a reserved value of T that
+// never occurs as a payload, then optional<T> stores its disengaged state in that value
+// and sizeof(optional<T>) == sizeof(T). Such an optional<T> is no longer-a std::optional<T>
+// but converts to and from it.
+template <typename T>
+struct optional_niche {};
+
+// reserve an address that no object of type *T can ever reside at. For pointers to scalars it
+// is an inactive union member and usable in constant expressions; classes may be incomplete or
+// abstract, there the address of a byte is cast at run time.
+template <typename T>
+	requires (std::is_pointer_v<T> && std::is_object_v<std::remove_pointer_t<T>>)
+struct niche_pointer {
+	[[nodiscard]] static constexpr T sentinel() noexcept {
+		if constexpr (std::is_scalar_v<object_type>)
+			return const_cast<T>(&anchor_.object);
+		else
+			return static_cast<T>(const_cast<void *>(static_cast<const volatile void *>(&anchor_.byte)));
+	}
+	[[nodiscard]] static constexpr bool is_sentinel(T p) noexcept { return p == sentinel(); }
+
+private:
+	using object_type = std::remove_cv_t<std::remove_pointer_t<T>>;
+	struct byte_anchor {
+		unsigned char byte = 0;
+	};
+	union scalar_anchor {
+		unsigned char byte = 0;
+		object_type object;
+	};
+	static constexpr std::conditional_t<std::is_scalar_v<object_type>, scalar_anchor, byte_anchor> anchor_{};
+};
+
+// reserve a quiet NaN with an unusual payload. Arithmetic propagates NaN payloads, so this is a
+// contract rather than a guarantee: an engaged optional must never hold exactly this NaN, e.g.
+// one copied from another computation's result bits. Other NaNs are fine payloads.
+template <std::floating_point T>
+	requires (sizeof(T) == sizeof(std::uint32_t) || sizeof(T) == sizeof(std::uint64_t))
+struct niche_nan {
+	using bits_type = std::conditional_t<sizeof(T) == sizeof(std::uint32_t), std::uint32_t, std::uint64_t>;
+	static constexpr bits_type bits = static_cast<bits_type>(
+		sizeof(T) == sizeof(std::uint32_t) ? 0x7FC0'0B05ull : 0x7FF8'0000'0000'0B05ull);
+
+	[[nodiscard]] static constexpr T sentinel() noexcept { return std::bit_cast<T>(bits); }
+	[[nodiscard]] static constexpr bool is_sentinel(T v) noexcept { return std::bit_cast<bits_type>(v) == bits; }
+};
+
+// reserve an enumerator (or any other value of the underlying type) of an enumeration
+template <typename E, E Reserved>
+	requires std::is_enum_v<E>
+struct niche_enum {
+	[[nodiscard]] static constexpr E sentinel() noexcept { return Reserved; }
+	[[nodiscard]] static constexpr bool is_sentinel(E v) noexcept { return v == Reserved; }
+};
+
+#ifdef OPTIONAL_NICHE_BUILTINS
+template <typename T>
+	requires std::is_object_v<T>
+struct optional_niche<T *> : niche_pointer<T *> {};
+
+template <std::floating_point T>
+	requires (sizeof(T) == sizeof(std::uint32_t) || sizeof(T) == sizeof(std::uint64_t))
+struct optional_niche<T> : niche_nan<T> {};
+#endif
+
 } // exported namespace OPTIONAL_NAMESPACE
 
 namespace OPTIONAL_NAMESPACE {
@@ -112,6 +248,20 @@ using base_optional = OPTIONAL_BASE_OPTIONAL<T>;
 template <typename T>
 inline constexpr bool dependent_false = false;
 
+#ifdef OPTIONAL_TELEMETRY
+template <typename T>
+constexpr void tally(std::atomic<std::uint64_t> optional_telemetry::*counter, bool condition = true) noexcept {
+	if (!std::is_constant_evaluated() && condition)
+		(telemetry<T>().*counter).fetch_add(1, std::memory_order_relaxed);
+}
+// bumps a counter of the payload type T of the enclosing optional<T>
+#define OPTIONAL_TALLY(counter) dtl::tally<T>(&optional_telemetry::counter)
+#define OPTIONAL_TALLY_IF(condition, counter) dtl::tally<T>(&optional_telemetry::counter, condition)
+#else
+#define OPTIONAL_TALLY(counter) static_cast<void>(0)
+#define OPTIONAL_TALLY_IF(condition, counter) static_cast<void>(0)
+#endif
+
 OPTIONAL_CONSTEVAL std::false_type optional_tag(...);
 template <typename T>
 OPTIONAL_CONSTEVAL std::true_type optional_tag(const volatile dtl::base_optional<T> *);
@@ -129,16 +279,77 @@ concept inplace_factory_type =
 	std::is_base_of_v<in_place_factory_base, std::decay_t<T>> ||
 	std::is_base_of_v<typed_in_place_factory_base, std::decay_t<T>>;
 
+// the customization point is probed first, it rules out almost every T at the lowest cost
+template <typename T>
+concept niche_type =
+	requires(const T & v) {
+		{ optional_niche<T>::sentinel() } -> std::same_as<T>;
+		{ optional_niche<T>::is_sentinel(v) } -> std::same_as<bool>;
+	} &&
+	std::is_object_v<T> && !std::is_const_v<T> && !std::is_volatile_v<T> &&
+	std::is_copy_constructible_v<T> && std::is_copy_assignable_v<T>;
+
+// an implicit conversion implies direct-initialization, therefore the four is_convertible
+// checks of [optional.ctor] are subsumed by their is_constructible counterparts
 template <typename T, typename U>
 concept compatible_optional_type =
 	(std::is_constructible_v<T, dtl::base_optional<U> &> ||
 	 std::is_constructible_v<T, const dtl::base_optional<U> &> ||
 	 std::is_constructible_v<T, const dtl::base_optional<U>> ||
-	 std::is_constructible_v<T, dtl::base_optional<U>> ||
-	 std::is_convertible_v<dtl::base_optional<U> &, T> ||
-	 std::is_convertible_v<const dtl::base_optional<U> &, T> ||
-	 std::is_convertible_v<const dtl::base_optional<U>, T> ||
-	 std::is_convertible_v<dtl::base_optional<U>, T>);
+	 std::is_constructible_v<T, dtl::base_optional<U>>);
+
+// converts to the result of a callable. Used as the only argument of a direct-initialization
+// of T, the returned prvalue is materialized right in the object being initialized (CWG 2327,
+// implemented by GCC, Clang and MSVC), even for types which can't be copied or moved.
+template <typename Func, typename T>
+concept result_convertible =
+	std::is_same_v<std::remove_cv_t<std::invoke_result_t<Func>>, T> ||
+	std::is_convertible_v<std::invoke_result_t<Func>, T>;
+
+template <typename T, typename Func>
+struct elide {
+	Func && f;
+	constexpr operator T() const { return std::invoke(static_cast<Func &&>(f)); }
+};
+
+// elide with the conversion deleted: T is constructible from it only if a constructor template of
+// T takes the proxy itself for an argument, e.g. template <typename U> T(U &&), rather than the T
+// it converts to
+template <typename T>
+struct elide_probe {
+	operator T() const = delete;
+};
+template <typename T>
+concept elidable = !std::is_constructible_v<T, elide_probe<T>>;
+
+// the argument making T from the result of f: the proxy, or for the T which would take the proxy
+// for something else, the result itself at the cost of a move
+template <typename T, typename Func>
+[[nodiscard]] constexpr decltype(auto) elide_result(Func && f) {
+	if constexpr (elidable<T>)
+		return elide<T, Func>{ static_cast<Func &&>(f) };
+	else
+		return std::invoke(static_cast<Func &&>(f));
+}
+
+// the value type of the result of transform: an lvalue reference stays a reference, such that
+// projections refer to subobjects rather than copying them. That's for lvalue arguments only,
+// projections of an rvalue are copied or moved out like in C++23 as the rvalue may be a temporary.
+template <typename Func, typename Arg>
+using transform_t = std::conditional_t<std::is_lvalue_reference_v<Arg> &&
+                                       std::is_lvalue_reference_v<std::invoke_result_t<Func, Arg>>,
+	std::invoke_result_t<Func, Arg>, std::remove_cvref_t<std::invoke_result_t<Func, Arg>>>;
+
+// the engaged result O of transform, its payload made right in place
+template <typename O, typename Func, typename Arg>
+[[nodiscard]] constexpr O transform(Func && f, Arg && arg) {
+	if constexpr (std::is_reference_v<typename O::value_type>)
+		return O(std::invoke(static_cast<Func &&>(f), static_cast<Arg &&>(arg)));
+	else
+		return O(std::in_place, elide_result<std::remove_cvref_t<std::invoke_result_t<Func, Arg>>>([&]() -> decltype(auto) {
+			return std::invoke(static_cast<Func &&>(f), static_cast<Arg &&>(arg));
+		}));
+}
 
 template <typename T>
 using unwrap_t = std::conditional_t<optional_type<T>,
@@ -199,6 +410,35 @@ concept tw_comparable =
 		{ (lhs <=> rhs) == 0 } -> bool_testable;
 	};
 
+// [expos.only.func] synth-three-way: operator<=> if available, else derived from operator<
+template <typename T, typename U>
+concept synth_comparable = tw_comparable<T, U> || (lt_comparable<T, U> && lt_comparable<U, T>);
+
+template <typename T, typename U>
+struct synth_three_way_result {
+	using type = std::weak_ordering;
+};
+template <typename T, typename U>
+	requires tw_comparable<T, U>
+struct synth_three_way_result<T, U> {
+	using type = std::compare_three_way_result_t<T, U>;
+};
+template <typename T, typename U>
+using synth_three_way_t = typename synth_three_way_result<T, U>::type;
+
+template <typename T, typename U>
+[[nodiscard]] constexpr synth_three_way_t<T, U> synth_three_way(const T & lhs, const U & rhs) {
+	if constexpr (tw_comparable<T, U>) {
+		return lhs <=> rhs;
+	} else {
+		if (lhs < rhs)
+			return std::weak_ordering::less;
+		if (rhs < lhs)
+			return std::weak_ordering::greater;
+		return std::weak_ordering::equivalent;
+	}
+}
+
 template <typename T, typename U>
 constexpr bool eq_v(const T & lhs, const U & rhs) {
 	if constexpr (eq_comparable<T, U>) {
@@ -263,6 +503,159 @@ constexpr bool ge_v(const T & lhs, const U & rhs) {
 	}
 }
 
+// arithmetic and pointer payloads are compared without branching on the engagement states: both
+// payloads are read, a disengaged one as zero, and the states are folded in by the non-short-
+// circuiting operators & and |. Random engagement, as in sort and join keys, then costs no
+// mispredictions.
+template <typename T>
+concept branchless = std::is_arithmetic_v<T> || std::is_pointer_v<T>;
+template <typename O>
+concept branchless_optional = branchless<typename std::remove_cvref_t<O>::value_type>;
+
+template <std::size_t Size>
+using bits_t = std::conditional_t<Size == 1, std::uint8_t,
+               std::conditional_t<Size == 2, std::uint16_t,
+               std::conditional_t<Size == 4, std::uint32_t,
+               std::conditional_t<Size == 8, std::uint64_t, void>>>>;
+
+template <typename T>
+inline constexpr T zero_payload{};
+
+// whether the payload of an engaged O starts at the address of O, as it does in all major standard
+// libraries. Proven by the compiler rather than assumed, anything else makes it false.
+template <typename O>
+[[nodiscard]] constexpr bool payload_at_start() {
+	const O probe(std::in_place);
+	return static_cast<const void *>(std::addressof(*probe)) == static_cast<const void *>(std::addressof(probe));
+}
+template <typename O>
+concept payload_first = requires { typename std::bool_constant<payload_at_start<O>()>; } && payload_at_start<O>();
+
+// a niche optional always holds a T, its payload bits are read regardless of the state and masked
+// by it. Other optionals hold no T while disengaged: the address of either the payload or a zero is
+// selected by masking, and read from. A select of the values themselves would become a branch.
+template <typename O>
+[[nodiscard]] constexpr auto payload_or_zero(const O & o) noexcept {
+	using T    = std::remove_cv_t<typename O::value_type>;
+	using bits = bits_t<sizeof(T)>;
+	if (!std::is_constant_evaluated()) {
+		if constexpr (niche_type<T> && !std::is_same_v<O, base_optional<T>> && !std::is_void_v<bits>) {
+			return std::bit_cast<T>(static_cast<bits>(std::bit_cast<bits>(*o) & (bits{ 0 } - o.has_value())));
+		} else if constexpr (payload_first<O>) {
+			const auto engaged = std::uintptr_t{ 0 } - o.has_value();
+			const auto payload = reinterpret_cast<std::uintptr_t>(std::addressof(o));
+			const auto zero    = reinterpret_cast<std::uintptr_t>(std::addressof(zero_payload<T>));
+			return *std::launder(reinterpret_cast<const T *>((payload & engaged) | (zero & ~engaged)));
+		}
+	}
+	return o.has_value() ? *o : T{};
+}
+
+template <typename L, typename R>
+[[nodiscard]] constexpr bool eq_opt(const L & lhs, const R & rhs) {
+	const bool lhv = lhs.has_value();
+	const bool rhv = rhs.has_value();
+	if constexpr (branchless_optional<L> && branchless_optional<R>)
+		return (lhv == rhv) & (!lhv | eq_v(payload_or_zero(lhs), payload_or_zero(rhs)));
+	else
+		return lhv == rhv && (!lhv || eq_v(*lhs, *rhs));
+}
+template <typename L, typename R>
+[[nodiscard]] constexpr bool ne_opt(const L & lhs, const R & rhs) {
+	const bool lhv = lhs.has_value();
+	const bool rhv = rhs.has_value();
+	if constexpr (branchless_optional<L> && branchless_optional<R>)
+		return (lhv != rhv) | (lhv & ne_v(payload_or_zero(lhs), payload_or_zero(rhs)));
+	else
+		return lhv != rhv || (lhv && ne_v(*lhs, *rhs));
+}
+template <typename L, typename R>
+[[nodiscard]] constexpr bool lt_opt(const L & lhs, const R & rhs) {
+	if constexpr (branchless_optional<L> && branchless_optional<R>)
+		return rhs.has_value() & (!lhs.has_value() | lt_v(payload_or_zero(lhs), payload_or_zero(rhs)));
+	else
+		return rhs.has_value() && (!lhs.has_value() || lt_v(*lhs, *rhs));
+}
+template <typename L, typename R>
+[[nodiscard]] constexpr bool gt_opt(const L & lhs, const R & rhs) {
+	if constexpr (branchless_optional<L> && branchless_optional<R>)
+		return lhs.has_value() & (!rhs.has_value() | gt_v(payload_or_zero(lhs), payload_or_zero(rhs)));
+	else
+		return lhs.has_value() && (!rhs.has_value() || gt_v(*lhs, *rhs));
+}
+template <typename L, typename R>
+[[nodiscard]] constexpr bool le_opt(const L & lhs, const R & rhs) {
+	if constexpr (branchless_optional<L> && branchless_optional<R>)
+		return (!lhs.has_value()) | (rhs.has_value() & le_v(payload_or_zero(lhs), payload_or_zero(rhs)));
+	else
+		return !lhs.has_value() || (rhs.has_value() && le_v(*lhs, *rhs));
+}
+template <typename L, typename R>
+[[nodiscard]] constexpr bool ge_opt(const L & lhs, const R & rhs) {
+	if constexpr (branchless_optional<L> && branchless_optional<R>)
+		return (!rhs.has_value()) | (lhs.has_value() & ge_v(payload_or_zero(lhs), payload_or_zero(rhs)));
+	else
+		return !rhs.has_value() || (lhs.has_value() && ge_v(*lhs, *rhs));
+}
+
+// o.has_value() && pred(*o), comparing with a U
+template <typename U, typename O, typename Pred>
+[[nodiscard]] constexpr bool engaged_and(const O & o, Pred pred) {
+	if constexpr (branchless_optional<O> && branchless<U>)
+		return o.has_value() & static_cast<bool>(pred(payload_or_zero(o)));
+	else
+		return o.has_value() && pred(*o);
+}
+// !o.has_value() || pred(*o), comparing with a U
+template <typename U, typename O, typename Pred>
+[[nodiscard]] constexpr bool disengaged_or(const O & o, Pred pred) {
+	if constexpr (branchless_optional<O> && branchless<U>)
+		return (!o.has_value()) | static_cast<bool>(pred(payload_or_zero(o)));
+	else
+		return !o.has_value() || pred(*o);
+}
+
+// an optional integer of up to 32 bits as a 64-bit key with the order of the optional: the state
+// above the payload, whose sign is flipped
+template <typename O>
+[[nodiscard]] constexpr std::uint64_t ordered_key(const O & o) noexcept {
+	using T = std::remove_cv_t<typename O::value_type>;
+	std::uint32_t payload;
+	if constexpr (std::is_signed_v<T>)
+		payload = static_cast<std::uint32_t>(static_cast<std::int32_t>(payload_or_zero(o))) ^ 0x8000'0000u;
+	else
+		payload = static_cast<std::uint32_t>(payload_or_zero(o));
+	return std::uint64_t{ o.has_value() } << 32 | payload;
+}
+
+// the three-way comparison of the payloads if both are engaged, of the states otherwise
+template <typename L, typename R>
+[[nodiscard]] constexpr auto tw_opt(const L & lhs, const R & rhs)
+	-> synth_three_way_t<typename L::value_type, typename R::value_type> {
+	using result = synth_three_way_t<typename L::value_type, typename R::value_type>;
+	using lhs_type = std::remove_cv_t<typename L::value_type>;
+	const bool lhv = lhs.has_value();
+	const bool rhv = rhs.has_value();
+	if constexpr (std::is_same_v<lhs_type, std::remove_cv_t<typename R::value_type>> &&
+	              std::is_integral_v<lhs_type> && sizeof(lhs_type) <= 4) {
+		return ordered_key(lhs) <=> ordered_key(rhs);
+	} else if constexpr (branchless_optional<L> && branchless_optional<R> &&
+	              (std::is_same_v<result, std::strong_ordering> || std::is_same_v<result, std::partial_ordering>)) {
+		const auto a      = payload_or_zero(lhs);
+		const auto b      = payload_or_zero(rhs);
+		const bool both   = lhv & rhv;
+		const int payload = static_cast<int>(a > b) - static_cast<int>(a < b);
+		const int state   = static_cast<int>(lhv) - static_cast<int>(rhv);
+		if constexpr (std::is_same_v<result, std::partial_ordering>) {
+			if (both & !(a == b) & (payload == 0)) [[unlikely]] // NaN
+				return std::partial_ordering::unordered;
+		}
+		return (state + (payload & -static_cast<int>(both))) <=> 0;
+	} else {
+		return lhv && rhv ? synth_three_way(*lhs, *rhs) : lhv <=> rhv;
+	}
+}
+
 } // non-exported namespace dtl
 OPTIONAL_NOEXPORT_END
 } // namespace OPTIONAL_NAMESPACE
@@ -282,36 +675,86 @@ class optional : public dtl::base_optional<T> {
 			f.apply(storage);
 	}
 
+	// the factory builds the payload in a local buffer, from there it is moved into the return slot
 	template <typename Factory>
 	T make_from(Factory && f) {
-		alignas(T) char storage[sizeof(T)];
+		alignas(T) unsigned char storage[sizeof(T)];
 		construct_at(storage, static_cast<Factory &&>(f));
-		return static_cast<T &&>(*std::launder(reinterpret_cast<T*>(storage)));
+		struct local {
+			T * p;
+			~local() { p->~T(); }
+		} const built{ std::launder(reinterpret_cast<T *>(storage)) };
+		return static_cast<T &&>(*built.p);
 	}
 
+	// the factory builds the payload directly in the storage of an engaged optional. If it throws,
+	// a value-initialized T fills the gap for the optional to be reset. Should that throw as well,
+	// the non-throwing destructor of the repair terminates.
 	template <typename Factory>
 	void replace_from(Factory && f) {
 		T * pstorage = this->operator->();
 		pstorage->~T();
+		struct repair {
+			optional * self;
+			~repair() {
+				if (self) {
+					::new (static_cast<void *>(self->operator->())) T();
+					self->reset();
+				}
+			}
+		} guard{ this };
 		construct_at(pstorage, static_cast<Factory &&>(f));
+		guard.self = nullptr;
+	}
+
+	// a disengaged std::optional exposes no storage: the factory builds the payload in a local
+	// buffer, from where it is moved once, elided all the way into the storage. Only payloads
+	// which can't be moved are default-constructed first and then replaced.
+	static constexpr bool replace_default = !std::is_move_constructible_v<T>;
+
+	// the state a converting constructor left, and whether it copied or moved the payload
+	constexpr void tally_converted([[maybe_unused]] bool copied) noexcept {
+		OPTIONAL_TALLY_IF(this->has_value(), engaged);
+		OPTIONAL_TALLY_IF(!this->has_value(), disengaged);
+		OPTIONAL_TALLY_IF(this->has_value() && copied, converting_copies);
+		OPTIONAL_TALLY_IF(this->has_value() && !copied, converting_moves);
+	}
+
+	template <typename Factory>
+	void construct_from(Factory && f) {
+		OPTIONAL_TALLY(factory);
+		if constexpr (replace_default) {
+			this->emplace();
+			replace_from(static_cast<Factory &&>(f));
+		} else {
+			this->emplace(dtl::elide_result<T>([&] { return make_from(static_cast<Factory &&>(f)); }));
+		}
 	}
 
 public:
 	using value_type = T;
 
 	// [optional.object.ctor]
+#ifdef OPTIONAL_TELEMETRY
+	[[nodiscard]] constexpr optional() noexcept { OPTIONAL_TALLY(disengaged); }
+#else
 	[[nodiscard]] constexpr optional() noexcept = default;
-	[[nodiscard]] constexpr optional(std::nullopt_t) noexcept {};
+#endif
+	[[nodiscard]] constexpr optional(std::nullopt_t) noexcept { OPTIONAL_TALLY(disengaged); }
 
 	template <typename... Args>
 		requires std::is_constructible_v<T, Args...>
 	[[nodiscard]] constexpr explicit optional(std::in_place_t, Args &&... args)
-	: base{ std::in_place, static_cast<Args &&>(args)... } {}
+	: base{ std::in_place, static_cast<Args &&>(args)... } {
+		OPTIONAL_TALLY(engaged);
+	}
 
 	template <typename U, typename... Args>
 		requires std::is_constructible_v<T, std::initializer_list<U> &, Args &&...>
 	[[nodiscard]] constexpr optional(std::in_place_t, std::initializer_list<U> il, Args &&... args)
-	: base{ std::in_place, il, static_cast<Args &&>(args)... } {}
+	: base{ std::in_place, il, static_cast<Args &&>(args)... } {
+		OPTIONAL_TALLY(engaged);
+	}
 
 	template <typename U>
 		requires (!dtl::optional_related<U> &&
@@ -319,25 +762,35 @@ public:
 		          !dtl::inplace_factory_type<U> &&
 		           std::is_constructible_v<T, U>)
 	[[nodiscard]] constexpr explicit(!std::is_convertible_v<U, T>)
-	optional(U && other) : base{ static_cast<U &&>(other) } {}
+	optional(U && other) : base{ static_cast<U &&>(other) } {
+		OPTIONAL_TALLY(engaged);
+		OPTIONAL_TALLY_IF(std::is_lvalue_reference_v<U>, converting_copies);
+		OPTIONAL_TALLY_IF(!std::is_lvalue_reference_v<U>, converting_moves);
+	}
 
 	template <typename U>
 		requires std::is_constructible_v<T, U>
 	[[nodiscard]] constexpr explicit(!std::is_convertible_v<U, T>)
-	optional(const optional<U &> & other) : base{ other ? base{*other} : base{} } {}
+	optional(const optional<U &> & other) : base{ other ? base{*other} : base{} } {
+		tally_converted(true);
+	}
 	template <typename U>
 		requires (!std::is_reference_v<U> &&
 		          !std::is_same_v<T, U> &&
 		          !dtl::compatible_optional_type<T, U>)
 	[[nodiscard]] explicit(!std::is_convertible_v<U, T>)
-	optional(const dtl::base_optional<U> & other) : base{ other } {}
+	optional(const dtl::base_optional<U> & other) : base{ other } {
+		tally_converted(true);
+	}
 
 	template <typename U>
 		requires (!std::is_reference_v<U> &&
 		          !std::is_same_v<T, U> &&
 		          !dtl::compatible_optional_type<T, U>)
 	[[nodiscard]] explicit(!std::is_convertible_v<U, T>)
-	optional(dtl::base_optional<U> && other) : base{ static_cast<dtl::base_optional<U> &&>(other) } {}
+	optional(dtl::base_optional<U> && other) : base{ static_cast<dtl::base_optional<U> &&>(other) } {
+		tally_converted(false);
+	}
 
 	// [optional.assign]
 	optional & operator=(std::nullopt_t) noexcept {
@@ -382,8 +835,14 @@ public:
 	}
 
 	// conversion from base
-	[[nodiscard]] constexpr optional(const base & from) : base(from) {}
-	[[nodiscard]] constexpr optional(base && from) noexcept : base(static_cast<base &&>(from)) {}
+	[[nodiscard]] constexpr optional(const base & from) : base(from) {
+		OPTIONAL_TALLY_IF(this->has_value(), engaged);
+		OPTIONAL_TALLY_IF(!this->has_value(), disengaged);
+	}
+	[[nodiscard]] constexpr optional(base && from) noexcept : base(static_cast<base &&>(from)) {
+		OPTIONAL_TALLY_IF(this->has_value(), engaged);
+		OPTIONAL_TALLY_IF(!this->has_value(), disengaged);
+	}
 
 	// non-standard additional Boost interfaces
 
@@ -395,52 +854,175 @@ public:
 	using argument_type        = T const &;
 
 	// construction
-	[[nodiscard]] constexpr optional(const T & other) : base{ other } {}
+	[[nodiscard]] constexpr optional(const T & other) : base{ other } {
+		OPTIONAL_TALLY(engaged);
+		OPTIONAL_TALLY(converting_copies);
+	}
 	[[nodiscard]] constexpr optional(T && other)
 		noexcept(std::is_nothrow_move_constructible_v<T>)
 		requires std::is_move_constructible_v<T>
-	: base{ static_cast<T &&>(other) } {}
+	: base{ static_cast<T &&>(other) } {
+		OPTIONAL_TALLY(engaged);
+		OPTIONAL_TALLY(converting_moves);
+	}
 
 	[[nodiscard]] constexpr optional(bool condition, const T & other)
-	: base{ condition ? base(other) : base{} } {}
+	: base{ condition ? base(other) : base{} } {
+		tally_converted(true);
+	}
 	[[nodiscard]] constexpr optional(bool condition, T && other)
 		noexcept(std::is_nothrow_move_constructible_v<T>)
 		requires std::is_move_constructible_v<T>
-	: base{ condition ? base(static_cast<T &&>(other)) : base{} } {}
+	: base{ condition ? base(static_cast<T &&>(other)) : base{} } {
+		tally_converted(false);
+	}
 
 	template <typename... Args>
 	constexpr optional(in_place_init_if_t, bool condition, Args &&... args)
-	: base{} { if (condition) this->emplace(static_cast<Args &&>(args)...); }
+	: base{} {
+		if (condition)
+			this->emplace(static_cast<Args &&>(args)...);
+		OPTIONAL_TALLY_IF(condition, engaged);
+		OPTIONAL_TALLY_IF(!condition, disengaged);
+	}
 
 	template <typename Factory>
-		requires (dtl::inplace_factory_type<Factory> && std::is_default_constructible_v<T>)
+		requires (dtl::inplace_factory_type<Factory> && replace_default)
 	explicit optional(Factory && f)
 	: base(std::in_place) {
 		replace_from(static_cast<Factory &&>(f));
+		OPTIONAL_TALLY(engaged);
+		OPTIONAL_TALLY(factory);
 	}
 	template <typename Factory>
-		requires (dtl::inplace_factory_type<Factory> && !std::is_default_constructible_v<T>)
+		requires (dtl::inplace_factory_type<Factory> && !replace_default)
 	explicit optional(Factory && f)
-	: base(std::in_place, make_from(static_cast<Factory &&>(f))) {}
+	: base(std::in_place, dtl::elide_result<T>([&] { return make_from(static_cast<Factory &&>(f)); })) {
+		OPTIONAL_TALLY(engaged);
+		OPTIONAL_TALLY(factory);
+	}
+
+	// uses-allocator construction: the payload is made by std::make_obj_using_allocator and elided
+	// into the storage. The allocator isn't kept, assigning a value to a disengaged optional later
+	// constructs it without; use emplace(std::allocator_arg, alloc, args...) instead.
+	template <typename Alloc>
+		requires std::uses_allocator_v<T, Alloc>
+	[[nodiscard]] constexpr optional(std::allocator_arg_t, const Alloc &) noexcept { OPTIONAL_TALLY(disengaged); }
+	template <typename Alloc>
+		requires std::uses_allocator_v<T, Alloc>
+	[[nodiscard]] constexpr optional(std::allocator_arg_t, const Alloc &, std::nullopt_t) noexcept {
+		OPTIONAL_TALLY(disengaged);
+	}
+
+	template <typename Alloc, typename... Args>
+		requires (std::uses_allocator_v<T, Alloc> && std::is_constructible_v<T, Args...>)
+	[[nodiscard]] constexpr explicit optional(std::allocator_arg_t, const Alloc & a, std::in_place_t, Args &&... args)
+	: base(std::in_place, dtl::elide_result<T>([&] {
+		return std::make_obj_using_allocator<T>(a, static_cast<Args &&>(args)...);
+	})) {
+		OPTIONAL_TALLY(engaged);
+	}
+
+	template <typename Alloc, typename U, typename... Args>
+		requires (std::uses_allocator_v<T, Alloc> &&
+		          std::is_constructible_v<T, std::initializer_list<U> &, Args &&...>)
+	[[nodiscard]] constexpr optional(std::allocator_arg_t, const Alloc & a, std::in_place_t, std::initializer_list<U> il,
+	                                 Args &&... args)
+	: base(std::in_place, dtl::elide_result<T>([&] {
+		return std::make_obj_using_allocator<T>(a, il, static_cast<Args &&>(args)...);
+	})) {
+		OPTIONAL_TALLY(engaged);
+	}
+
+	template <typename Alloc>
+		requires std::uses_allocator_v<T, Alloc>
+	[[nodiscard]] optional(std::allocator_arg_t, const Alloc & a, bool condition, const T & other) {
+		if (condition)
+			emplace(std::allocator_arg, a, other);
+		tally_converted(true);
+	}
+	template <typename Alloc>
+		requires (std::uses_allocator_v<T, Alloc> && std::is_move_constructible_v<T>)
+	[[nodiscard]] optional(std::allocator_arg_t, const Alloc & a, bool condition, T && other) {
+		if (condition)
+			emplace(std::allocator_arg, a, static_cast<T &&>(other));
+		tally_converted(false);
+	}
+
+	template <typename Alloc, typename... Args>
+		requires std::uses_allocator_v<T, Alloc>
+	optional(std::allocator_arg_t, const Alloc & a, in_place_init_if_t, bool condition, Args &&... args) {
+		if (condition)
+			emplace(std::allocator_arg, a, static_cast<Args &&>(args)...);
+		OPTIONAL_TALLY_IF(condition, engaged);
+		OPTIONAL_TALLY_IF(!condition, disengaged);
+	}
+
+	template <typename Alloc, typename U>
+		requires (std::uses_allocator_v<T, Alloc> &&
+		          !dtl::optional_related<U> &&
+		          !dtl::inplace_factory_type<U> &&
+		           std::is_constructible_v<T, U>)
+	[[nodiscard]] constexpr explicit(!std::is_convertible_v<U, T>)
+	optional(std::allocator_arg_t, const Alloc & a, U && other)
+	: optional(std::allocator_arg, a, std::in_place, static_cast<U &&>(other)) {}
+
+	// from optional<T>, optional<U>, optional<U &> or std::optional<U>
+	template <typename Alloc, typename O>
+		requires (std::uses_allocator_v<T, Alloc> &&
+		          dtl::optional_type<O> &&
+		          std::is_constructible_v<T, decltype(*std::declval<O>())>)
+	[[nodiscard]] constexpr optional(std::allocator_arg_t, const Alloc & a, O && other) {
+		if (other.has_value())
+			emplace(std::allocator_arg, a, *static_cast<O &&>(other));
+		tally_converted(std::is_lvalue_reference_v<decltype(*static_cast<O &&>(other))>);
+	}
+
+	// the factory can't take the allocator, the payload is moved into the allocator's storage
+	template <typename Alloc, typename Factory>
+		requires (std::uses_allocator_v<T, Alloc> && dtl::inplace_factory_type<Factory>)
+	[[nodiscard]] explicit optional(std::allocator_arg_t, const Alloc & a, Factory && f) {
+		emplace(std::allocator_arg, a, make_from(static_cast<Factory &&>(f)));
+		OPTIONAL_TALLY(engaged);
+		OPTIONAL_TALLY(factory);
+	}
 
 	// assignment
 	template <typename Factory>
 		requires dtl::inplace_factory_type<Factory>
 	optional<T> & operator=(Factory && f) {
-		if (*this) {
+		if (!*this) {
+			construct_from(static_cast<Factory &&>(f));
+		} else if constexpr (std::is_nothrow_default_constructible_v<T> || replace_default) {
+			// right in the storage, exactly once
+			OPTIONAL_TALLY(replace);
 			replace_from(static_cast<Factory &&>(f));
 		} else {
-			if constexpr (std::is_default_constructible_v<T>) {
-				this->emplace();
-				replace_from(static_cast<Factory &&>(f));
-			} else {
-				this->emplace(make_from(static_cast<Factory &&>(f)));
-			}
+			this->reset();
+			construct_from(static_cast<Factory &&>(f));
 		}
 		return *this;
 	}
 
 	// observers
+#ifdef OPTIONAL_TELEMETRY
+	[[nodiscard]] constexpr T & value() & {
+		OPTIONAL_TALLY_IF(!this->has_value(), bad_access);
+		return base::value();
+	}
+	[[nodiscard]] constexpr const T & value() const & {
+		OPTIONAL_TALLY_IF(!this->has_value(), bad_access);
+		return base::value();
+	}
+	[[nodiscard]] constexpr T && value() && {
+		OPTIONAL_TALLY_IF(!this->has_value(), bad_access);
+		return static_cast<base &&>(*this).value();
+	}
+	[[nodiscard]] constexpr const T && value() const && {
+		OPTIONAL_TALLY_IF(!this->has_value(), bad_access);
+		return static_cast<const base &&>(*this).value();
+	}
+#endif
 	[[nodiscard]] constexpr const T & get() const { return **this; }
 	[[nodiscard]] constexpr T & get() { return **this; }
 
@@ -506,6 +1088,77 @@ public:
 		return none;
 	}
 
+	// C++23 monadic operations. Callables are invoked, and thereby may be pointers to members.
+	// transform makes its payload right in place and keeps lvalue references, e.g.
+	// record.transform(&record::header) refers to the header in the record rather than copying it.
+	// On an rvalue optional, the result always holds a value.
+	template <typename Func>
+	[[nodiscard]] constexpr optional<dtl::transform_t<Func, T &>>
+	transform(Func && f) & {
+		if (this->has_value())
+			return dtl::transform<optional<dtl::transform_t<Func, T &>>>(static_cast<Func &&>(f), **this);
+		return none;
+	}
+
+	template <typename Func>
+	[[nodiscard]] constexpr optional<dtl::transform_t<Func, const T &>>
+	transform(Func && f) const & {
+		if (this->has_value())
+			return dtl::transform<optional<dtl::transform_t<Func, const T &>>>(static_cast<Func &&>(f), **this);
+		return none;
+	}
+
+	template <typename Func>
+	[[nodiscard]] constexpr optional<dtl::transform_t<Func, T &&>>
+	transform(Func && f) && {
+		if (this->has_value())
+			return dtl::transform<optional<dtl::transform_t<Func, T &&>>>(static_cast<Func &&>(f), static_cast<T &&>(**this));
+		return none;
+	}
+
+	template <typename Func>
+		requires dtl::optional_type<std::invoke_result_t<Func, T &>>
+	[[nodiscard]] constexpr std::remove_cvref_t<std::invoke_result_t<Func, T &>>
+	and_then(Func && f) & {
+		if (this->has_value())
+			return std::invoke(static_cast<Func &&>(f), **this);
+		return none;
+	}
+
+	template <typename Func>
+		requires dtl::optional_type<std::invoke_result_t<Func, const T &>>
+	[[nodiscard]] constexpr std::remove_cvref_t<std::invoke_result_t<Func, const T &>>
+	and_then(Func && f) const & {
+		if (this->has_value())
+			return std::invoke(static_cast<Func &&>(f), **this);
+		return none;
+	}
+
+	template <typename Func>
+		requires dtl::optional_type<std::invoke_result_t<Func, T &&>>
+	[[nodiscard]] constexpr std::remove_cvref_t<std::invoke_result_t<Func, T &&>>
+	and_then(Func && f) && {
+		if (this->has_value())
+			return std::invoke(static_cast<Func &&>(f), static_cast<T &&>(**this));
+		return none;
+	}
+
+	template <typename Func>
+		requires std::is_same_v<std::remove_cvref_t<std::invoke_result_t<Func>>, optional>
+	[[nodiscard]] constexpr optional or_else(Func && f) const & {
+		if (this->has_value())
+			return *this;
+		return std::invoke(static_cast<Func &&>(f));
+	}
+
+	template <typename Func>
+		requires std::is_same_v<std::remove_cvref_t<std::invoke_result_t<Func>>, optional>
+	[[nodiscard]] constexpr optional or_else(Func && f) && {
+		if (this->has_value())
+			return static_cast<optional &&>(*this);
+		return std::invoke(static_cast<Func &&>(f));
+	}
+
 	[[nodiscard]] constexpr const T & get_value_or(const T & replacement) const {
 		return this->has_value() ? **this : replacement;
 	}
@@ -525,6 +1178,22 @@ public:
 	// modifiers
 	constexpr void reset() { base::reset(); }
 
+	using base::emplace;
+	template <typename Alloc, typename... Args>
+		requires (std::uses_allocator_v<T, Alloc> && std::is_constructible_v<T, Args...>)
+	constexpr T & emplace(std::allocator_arg_t, const Alloc & a, Args &&... args) {
+		return base::emplace(dtl::elide_result<T>([&] {
+			return std::make_obj_using_allocator<T>(a, static_cast<Args &&>(args)...);
+		}));
+	}
+
+	// the payload is the result of f(), materialized right in the storage by guaranteed copy elision
+	template <typename Func>
+		requires dtl::result_convertible<Func, T>
+	constexpr T & emplace_from(Func && f) {
+		return this->emplace(dtl::elide_result<T>(static_cast<Func &&>(f)));
+	}
+
 	// deprecated
 	// observers
 	OPTIONAL_DEPRECATED [[nodiscard]] constexpr bool is_initialized() const noexcept {
@@ -651,7 +1320,7 @@ public:
 	constexpr bool operator!() const noexcept { return p_ == nullptr; }
 
 	template <typename Func>
-	[[nodiscard]] optional<std::invoke_result_t<Func, T &>>
+	[[nodiscard]] constexpr optional<std::invoke_result_t<Func, T &>>
 	map(Func f) const {
 		if (this->has_value())
 			return f(**this);
@@ -659,15 +1328,42 @@ public:
 	}
 
 	template <typename Func>
-	[[nodiscard]] optional<dtl::unwrap_t<std::invoke_result_t<Func, T &>>>
+	[[nodiscard]] constexpr optional<dtl::unwrap_t<std::invoke_result_t<Func, T &>>>
 	flat_map(Func f) const {
 		if (this->has_value())
 			return f(**this);
 		return none;
 	}
 
+	// C++23 monadic operations. Callables are invoked, and thereby may be pointers to members.
+	// transform keeps lvalue references, see optional<T>.
+	template <typename Func>
+	[[nodiscard]] constexpr optional<dtl::transform_t<Func, T &>>
+	transform(Func && f) const {
+		if (p_)
+			return dtl::transform<optional<dtl::transform_t<Func, T &>>>(static_cast<Func &&>(f), *p_);
+		return none;
+	}
+
+	template <typename Func>
+		requires dtl::optional_type<std::invoke_result_t<Func, T &>>
+	[[nodiscard]] constexpr std::remove_cvref_t<std::invoke_result_t<Func, T &>>
+	and_then(Func && f) const {
+		if (p_)
+			return std::invoke(static_cast<Func &&>(f), *p_);
+		return none;
+	}
+
 	template <typename Func>
-	[[nodiscard]] T & value_or_eval(Func f) const {
+		requires std::is_same_v<std::remove_cvref_t<std::invoke_result_t<Func>>, optional>
+	[[nodiscard]] constexpr optional or_else(Func && f) const {
+		if (p_)
+			return *this;
+		return std::invoke(static_cast<Func &&>(f));
+	}
+
+	template <typename Func>
+	[[nodiscard]] constexpr T & value_or_eval(Func f) const {
 		taint_rvalue<std::invoke_result_t<Func>>{};
 		return p_ ? *p_ : f();
 	}
@@ -695,110 +1391,566 @@ public:
 	}
 }; // class optional<T &>
 
+// [optional.niche]
+template <typename T>
+	requires dtl::niche_type<T>
+class optional<T> {
+	template <typename U>
+	friend OPTIONAL_CONSTEVAL std::true_type optional_tag(const volatile optional<U> *);
+
+	using niche = optional_niche<T>;
+	using base  = dtl::base_optional<T>;
+
+	template <typename Factory>
+	T make_from(Factory && f) {
+		alignas(T) unsigned char storage[sizeof(T)];
+		if constexpr (std::is_convertible_v<Factory *, ::boost::in_place_factory_base *>)
+			f.template apply<T>(storage);
+		else
+			f.apply(storage);
+		T * p = std::launder(reinterpret_cast<T *>(storage));
+		T result = static_cast<T &&>(*p);
+		p->~T();
+		return result;
+	}
+
+	T v_ = niche::sentinel();
+
+	constexpr void tally_converted([[maybe_unused]] bool copied) noexcept {
+		OPTIONAL_TALLY_IF(has_value(), engaged);
+		OPTIONAL_TALLY_IF(!has_value(), disengaged);
+		OPTIONAL_TALLY_IF(has_value() && copied, converting_copies);
+		OPTIONAL_TALLY_IF(has_value() && !copied, converting_moves);
+	}
+
+public:
+	using value_type = T;
+
+	// [optional.object.ctor]
+#ifdef OPTIONAL_TELEMETRY
+	[[nodiscard]] constexpr optional() noexcept(noexcept(niche::sentinel())) { OPTIONAL_TALLY(disengaged); }
+#else
+	[[nodiscard]] constexpr optional() noexcept(noexcept(niche::sentinel())) = default;
+#endif
+	[[nodiscard]] constexpr optional(std::nullopt_t) noexcept(noexcept(niche::sentinel())) {
+		OPTIONAL_TALLY(disengaged);
+	}
+	[[nodiscard]] constexpr optional(const optional & other) = default;
+	[[nodiscard]] constexpr optional(optional && other)      = default;
+
+	template <typename... Args>
+		requires std::is_constructible_v<T, Args...>
+	[[nodiscard]] constexpr explicit optional(std::in_place_t, Args &&... args)
+	: v_(static_cast<Args &&>(args)...) {
+		OPTIONAL_TALLY(engaged);
+	}
+
+	template <typename U, typename... Args>
+		requires std::is_constructible_v<T, std::initializer_list<U> &, Args &&...>
+	[[nodiscard]] constexpr optional(std::in_place_t, std::initializer_list<U> il, Args &&... args)
+	: v_(il, static_cast<Args &&>(args)...) {
+		OPTIONAL_TALLY(engaged);
+	}
+
+	template <typename U>
+		requires (!dtl::optional_related<U> &&
+		          !std::is_same_v<T, std::decay_t<U>> &&
+		          !dtl::inplace_factory_type<U> &&
+		           std::is_constructible_v<T, U>)
+	[[nodiscard]] constexpr explicit(!std::is_convertible_v<U, T>)
+	optional(U && other) : v_(static_cast<U &&>(other)) {
+		OPTIONAL_TALLY(engaged);
+		OPTIONAL_TALLY_IF(std::is_lvalue_reference_v<U>, converting_copies);
+		OPTIONAL_TALLY_IF(!std::is_lvalue_reference_v<U>, converting_moves);
+	}
+
+	template <typename U>
+		requires std::is_constructible_v<T, U>
+	[[nodiscard]] constexpr explicit(!std::is_convertible_v<U, T>)
+	optional(const optional<U &> & other) {
+		if (other)
+			v_ = T(*other);
+		tally_converted(true);
+	}
+
+	template <typename U>
+		requires std::is_constructible_v<T, const U &>
+	[[nodiscard]] constexpr explicit(!std::is_convertible_v<const U &, T>)
+	optional(const dtl::base_optional<U> & other) {
+		if (other)
+			v_ = T(*other);
+		tally_converted(true);
+	}
+
+	template <typename U>
+		requires std::is_constructible_v<T, U>
+	[[nodiscard]] constexpr explicit(!std::is_convertible_v<U, T>)
+	optional(dtl::base_optional<U> && other) {
+		if (other)
+			v_ = T(static_cast<U &&>(*other));
+		tally_converted(false);
+	}
+
+	// [optional.assign]
+	constexpr optional & operator=(const optional & rhs) = default;
+	constexpr optional & operator=(optional && rhs)      = default;
+
+	constexpr optional & operator=(std::nullopt_t) noexcept(noexcept(niche::sentinel())) {
+		v_ = niche::sentinel();
+		return *this;
+	}
+
+	template <typename U = T>
+		requires (!std::is_same_v<optional, std::remove_cvref_t<U>> &&
+		          !dtl::optional_related<U> &&
+		          !dtl::inplace_factory_type<U> &&
+		          std::is_constructible_v<T, U> && std::is_assignable_v<T &, U>)
+	constexpr optional & operator=(U && rhs) {
+		v_ = static_cast<U &&>(rhs);
+		return *this;
+	}
+
+	template <typename U>
+		requires std::is_constructible_v<T, const U &>
+	constexpr optional & operator=(const dtl::base_optional<U> & rhs) {
+		return *this = optional(rhs);
+	}
+
+	template <typename U>
+		requires std::is_constructible_v<T, U>
+	constexpr optional & operator=(dtl::base_optional<U> && rhs) {
+		return *this = optional(static_cast<dtl::base_optional<U> &&>(rhs));
+	}
+
+	template <typename U>
+		requires std::is_constructible_v<T, const U &>
+	constexpr optional & operator=(const optional<U &> & rhs) {
+		return *this = optional(rhs);
+	}
+
+	template <typename... Args>
+		requires std::is_constructible_v<T, Args...>
+	constexpr T & emplace(Args &&... args) {
+		v_ = T(static_cast<Args &&>(args)...);
+		return v_;
+	}
+
+	template <typename U, typename... Args>
+		requires std::is_constructible_v<T, std::initializer_list<U> &, Args &&...>
+	constexpr T & emplace(std::initializer_list<U> il, Args &&... args) {
+		v_ = T(il, static_cast<Args &&>(args)...);
+		return v_;
+	}
+
+	template <typename Func>
+		requires dtl::result_convertible<Func, T>
+	constexpr T & emplace_from(Func && f) {
+		v_ = std::invoke(static_cast<Func &&>(f));
+		return v_;
+	}
+
+	// [optional.swap]
+	constexpr void swap(optional & rhs) noexcept(std::is_nothrow_swappable_v<T>) {
+		using std::swap;
+		swap(v_, rhs.v_);
+	}
+
+	// [optional.observe]
+	constexpr const T * operator->() const noexcept { return std::addressof(v_); }
+	constexpr T * operator->() noexcept { return std::addressof(v_); }
+	constexpr const T & operator*() const & noexcept { return v_; }
+	constexpr T & operator*() & noexcept { return v_; }
+	constexpr T && operator*() && noexcept { return static_cast<T &&>(v_); }
+	constexpr const T && operator*() const && noexcept { return static_cast<const T &&>(v_); }
+
+	[[nodiscard]] constexpr explicit operator bool() const noexcept { return !niche::is_sentinel(v_); }
+	[[nodiscard]] constexpr bool has_value() const noexcept { return !niche::is_sentinel(v_); }
+
+	[[nodiscard]] constexpr const T & value() const & {
+		OPTIONAL_TALLY_IF(!has_value(), bad_access);
+		return has_value() ? v_ : throw bad_optional_access();
+	}
+	[[nodiscard]] constexpr T & value() & {
+		OPTIONAL_TALLY_IF(!has_value(), bad_access);
+		return has_value() ? v_ : throw bad_optional_access();
+	}
+	[[nodiscard]] constexpr T && value() && {
+		OPTIONAL_TALLY_IF(!has_value(), bad_access);
+		return has_value() ? static_cast<T &&>(v_) : throw bad_optional_access();
+	}
+
+	template <typename U>
+	[[nodiscard]] constexpr T value_or(U && replacement) const & {
+		return has_value() ? v_ : static_cast<T>(static_cast<U &&>(replacement));
+	}
+	template <typename U>
+	[[nodiscard]] constexpr T value_or(U && replacement) && {
+		return has_value() ? static_cast<T &&>(v_) : static_cast<T>(static_cast<U &&>(replacement));
+	}
+
+	// [optional.mod]
+	constexpr void reset() noexcept(noexcept(niche::sentinel())) { v_ = niche::sentinel(); }
+
+	// conversion to and from base
+	[[nodiscard]] constexpr optional(const base & from) {
+		if (from)
+			v_ = *from;
+		OPTIONAL_TALLY_IF(has_value(), engaged);
+		OPTIONAL_TALLY_IF(!has_value(), disengaged);
+	}
+	[[nodiscard]] constexpr operator base() const {
+		return has_value() ? base{ v_ } : base{};
+	}
+
+	// non-standard additional Boost interfaces
+
+	using reference_type       = T &;
+	using reference_const_type = const T &;
+	using rval_reference_type  = T &&;
+	using pointer_type         = T *;
+	using pointer_const_type   = const T *;
+	using argument_type        = T const &;
+
+	// construction
+	[[nodiscard]] constexpr optional(const T & other) : v_(other) { tally_converted(true); }
+	[[nodiscard]] constexpr optional(T && other) noexcept(std::is_nothrow_move_constructible_v<T>)
+	: v_(static_cast<T &&>(other)) {
+		tally_converted(false);
+	}
+
+	[[nodiscard]] constexpr optional(bool condition, const T & other)
+	: v_(condition ? other : niche::sentinel()) {
+		tally_converted(true);
+	}
+	[[nodiscard]] constexpr optional(bool condition, T && other)
+	: v_(condition ? static_cast<T &&>(other) : niche::sentinel()) {
+		tally_converted(false);
+	}
+
+	template <typename... Args>
+	constexpr optional(in_place_init_if_t, bool condition, Args &&... args) {
+		if (condition)
+			this->emplace(static_cast<Args &&>(args)...);
+		OPTIONAL_TALLY_IF(condition, engaged);
+		OPTIONAL_TALLY_IF(!condition, disengaged);
+	}
+
+	template <typename Factory>
+		requires dtl::inplace_factory_type<Factory>
+	explicit optional(Factory && f)
+	: v_(make_from(static_cast<Factory &&>(f))) {
+		OPTIONAL_TALLY(engaged);
+		OPTIONAL_TALLY(factory);
+	}
+
+	// assignment
+	template <typename Factory>
+		requires dtl::inplace_factory_type<Factory>
+	optional & operator=(Factory && f) {
+		OPTIONAL_TALLY_IF(!has_value(), factory);
+		OPTIONAL_TALLY_IF(has_value(), replace);
+		v_ = make_from(static_cast<Factory &&>(f));
+		return *this;
+	}
+
+	// observers
+	[[nodiscard]] constexpr const T & get() const { return v_; }
+	[[nodiscard]] constexpr T & get() { return v_; }
+
+	[[nodiscard]] constexpr const T * get_ptr() const {
+		return has_value() ? std::addressof(v_) : nullptr;
+	}
+	[[nodiscard]] constexpr T * get_ptr() {
+		return has_value() ? std::addressof(v_) : nullptr;
+	}
+
+	[[nodiscard]] constexpr bool operator!() const noexcept { return !has_value(); }
+
+	template <typename Func>
+	[[nodiscard]] constexpr optional<std::invoke_result_t<Func, T &>>
+	map(Func f) & {
+		if (has_value())
+			return f(v_);
+		return none;
+	}
+
+	template <typename Func>
+	[[nodiscard]] constexpr optional<std::invoke_result_t<Func, const T &>>
+	map(Func f) const & {
+		if (has_value())
+			return f(v_);
+		return none;
+	}
+
+	template <typename Func>
+	[[nodiscard]] constexpr optional<std::invoke_result_t<Func, T &&>>
+	map(Func f) && {
+		if (has_value())
+			return f(static_cast<T &&>(v_));
+		return none;
+	}
+
+	template <typename Func>
+	[[nodiscard]] constexpr
+		optional<dtl::unwrap_t<std::invoke_result_t<Func, T &>>>
+	flat_map(Func f) & {
+		if (has_value())
+			return f(v_);
+		return none;
+	}
+
+	template <typename Func>
+	[[nodiscard]] constexpr
+		optional<dtl::unwrap_t<std::invoke_result_t<Func, const T &>>>
+	flat_map(Func f) const & {
+		if (has_value())
+			return f(v_);
+		return none;
+	}
+
+	template <typename Func>
+	[[nodiscard]] constexpr
+		optional<dtl::unwrap_t<std::invoke_result_t<Func, T &&>>>
+	flat_map(Func f) && {
+		if (has_value())
+			return f(static_cast<T &&>(v_));
+		return none;
+	}
+
+	// C++23 monadic operations. Callables are invoked, and thereby may be pointers to members.
+	// transform makes its payload right in place and keeps lvalue references, e.g.
+	// record.transform(&record::header) refers to the header in the record rather than copying it.
+	// On an rvalue optional, the result always holds a value.
+	template <typename Func>
+	[[nodiscard]] constexpr optional<dtl::transform_t<Func, T &>>
+	transform(Func && f) & {
+		if (has_value())
+			return dtl::transform<optional<dtl::transform_t<Func, T &>>>(static_cast<Func &&>(f), v_);
+		return none;
+	}
+
+	template <typename Func>
+	[[nodiscard]] constexpr optional<dtl::transform_t<Func, const T &>>
+	transform(Func && f) const & {
+		if (has_value())
+			return dtl::transform<optional<dtl::transform_t<Func, const T &>>>(static_cast<Func &&>(f), v_);
+		return none;
+	}
+
+	template <typename Func>
+	[[nodiscard]] constexpr optional<dtl::transform_t<Func, T &&>>
+	transform(Func && f) && {
+		if (has_value())
+			return dtl::transform<optional<dtl::transform_t<Func, T &&>>>(static_cast<Func &&>(f), static_cast<T &&>(v_));
+		return none;
+	}
+
+	template <typename Func>
+		requires dtl::optional_type<std::invoke_result_t<Func, T &>>
+	[[nodiscard]] constexpr std::remove_cvref_t<std::invoke_result_t<Func, T &>>
+	and_then(Func && f) & {
+		if (has_value())
+			return std::invoke(static_cast<Func &&>(f), v_);
+		return none;
+	}
+
+	template <typename Func>
+		requires dtl::optional_type<std::invoke_result_t<Func, const T &>>
+	[[nodiscard]] constexpr std::remove_cvref_t<std::invoke_result_t<Func, const T &>>
+	and_then(Func && f) const & {
+		if (has_value())
+			return std::invoke(static_cast<Func &&>(f), v_);
+		return none;
+	}
+
+	template <typename Func>
+		requires dtl::optional_type<std::invoke_result_t<Func, T &&>>
+	[[nodiscard]] constexpr std::remove_cvref_t<std::invoke_result_t<Func, T &&>>
+	and_then(Func && f) && {
+		if (has_value())
+			return std::invoke(static_cast<Func &&>(f), static_cast<T &&>(v_));
+		return none;
+	}
+
+	template <typename Func>
+		requires std::is_same_v<std::remove_cvref_t<std::invoke_result_t<Func>>, optional>
+	[[nodiscard]] constexpr optional or_else(Func && f) const & {
+		if (has_value())
+			return *this;
+		return std::invoke(static_cast<Func &&>(f));
+	}
+
+	template <typename Func>
+		requires std::is_same_v<std::remove_cvref_t<std::invoke_result_t<Func>>, optional>
+	[[nodiscard]] constexpr optional or_else(Func && f) && {
+		if (has_value())
+			return static_cast<optional &&>(*this);
+		return std::invoke(static_cast<Func &&>(f));
+	}
+
+	[[nodiscard]] constexpr const T & get_value_or(const T & replacement) const {
+		return has_value() ? v_ : replacement;
+	}
+	[[nodiscard]] constexpr T & get_value_or(T & replacement) {
+		return has_value() ? v_ : replacement;
+	}
+
+	template <typename Func>
+	[[nodiscard]] constexpr T value_or_eval(Func f) const & {
+		return has_value() ? v_ : f();
+	}
+	template <typename Func>
+	[[nodiscard]] constexpr T value_or_eval(Func f) && {
+		return has_value() ? static_cast<T &&>(v_) : f();
+	}
+
+	// deprecated
+	// observers
+	OPTIONAL_DEPRECATED [[nodiscard]] constexpr bool is_initialized() const noexcept {
+		return has_value();
+	}
+	// modifiers
+	OPTIONAL_DEPRECATED constexpr void reset(T const & rhs) { *this = rhs; }
+}; // class optional<T> with niche
+
 // [optional.relops]
+#ifdef OPTIONAL_THREE_WAY
+// == and <=> only: the compiler rewrites !=, <, >, <= and >= from them, in both operand orders.
+// Payloads without <=> are ordered by their operator<.
 template <typename T, typename U>
 [[nodiscard]] constexpr bool operator==(const optional<T> & lhs, const optional<U> & rhs) {
-	const bool lhv = lhs.has_value();
-	return lhv == rhs.has_value() && (!lhv || dtl::eq_v(*lhs, *rhs));
+	return dtl::eq_opt(lhs, rhs);
 }
 template <typename T, typename U>
 [[nodiscard]] constexpr bool operator==(const optional<T> & lhs, const dtl::base_optional<U> & rhs) {
-	const bool lhv = lhs.has_value();
-	return lhv == rhs.has_value() && (!lhv || dtl::eq_v(*lhs, *rhs));
+	return dtl::eq_opt(lhs, rhs);
 }
+
 template <typename T, typename U>
-[[nodiscard]] constexpr bool operator==(const dtl::base_optional<U> & lhs, const optional<U> & rhs) {
-	const bool lhv = lhs.has_value();
-	return lhv == rhs.has_value() && (!lhv || dtl::eq_v(*lhs, *rhs));
+	requires dtl::synth_comparable<T, U>
+[[nodiscard]] constexpr dtl::synth_three_way_t<T, U>
+operator<=>(const optional<T> & lhs, const optional<U> & rhs) {
+	return dtl::tw_opt(lhs, rhs);
+}
+template <typename T, typename U>
+	requires dtl::synth_comparable<T, U>
+[[nodiscard]] constexpr dtl::synth_three_way_t<T, U>
+operator<=>(const optional<T> & lhs, const dtl::base_optional<U> & rhs) {
+	return dtl::tw_opt(lhs, rhs);
+}
+
+// [optional.nullops]
+template <typename T>
+[[nodiscard]] constexpr bool operator==(const optional<T> & o, std::nullopt_t) noexcept {
+	return !o.has_value();
+}
+template <typename T>
+[[nodiscard]] constexpr std::strong_ordering operator<=>(const optional<T> & o, std::nullopt_t) noexcept {
+	return o.has_value() <=> false;
+}
+
+// [optional.comp_with_t]
+template <typename T, typename U>
+	requires (!dtl::optional_related<U>) &&
+	         (dtl::eq_comparable<T, U> || dtl::ne_comparable<T, U>)
+[[nodiscard]] constexpr bool operator==(const optional<T> & lhs, const U & rhs) {
+	return dtl::engaged_and<U>(lhs, [&](const auto & v) { return dtl::eq_v(v, rhs); });
+}
+template <typename T, typename U>
+	requires (!dtl::optional_related<U>) && dtl::synth_comparable<T, U>
+[[nodiscard]] constexpr dtl::synth_three_way_t<T, U>
+operator<=>(const optional<T> & lhs, const U & rhs) {
+	if constexpr (dtl::branchless<T> && dtl::branchless<U>) {
+		using ordering = dtl::synth_three_way_t<T, U>;
+		using bits     = dtl::bits_t<sizeof(ordering)>;
+		const bits payload = std::bit_cast<bits>(ordering{ dtl::payload_or_zero(lhs) <=> rhs });
+		const bits less    = std::bit_cast<bits>(ordering{ std::strong_ordering::less });
+		const bits engaged = bits{ 0 } - lhs.has_value();
+		return std::bit_cast<ordering>(static_cast<bits>((payload & engaged) | (less & ~engaged)));
+	} else {
+		return lhs.has_value() ? dtl::synth_three_way(*lhs, rhs) : std::strong_ordering::less;
+	}
+}
+
+#else
+template <typename T, typename U>
+[[nodiscard]] constexpr bool operator==(const optional<T> & lhs, const optional<U> & rhs) {
+	return dtl::eq_opt(lhs, rhs);
+}
+template <typename T, typename U>
+[[nodiscard]] constexpr bool operator==(const optional<T> & lhs, const dtl::base_optional<U> & rhs) {
+	return dtl::eq_opt(lhs, rhs);
+}
+template <typename T, typename U>
+[[nodiscard]] constexpr bool operator==(const dtl::base_optional<T> & lhs, const optional<U> & rhs) {
+	return dtl::eq_opt(lhs, rhs);
 }
 
 template <typename T, typename U>
 [[nodiscard]] constexpr bool operator!=(const optional<T> & lhs, const optional<U> & rhs) {
-	const bool lhv = lhs.has_value();
-	return lhv != rhs.has_value() || (lhv && dtl::ne_v(*lhs, *rhs));
+	return dtl::ne_opt(lhs, rhs);
 }
 template <typename T, typename U>
 [[nodiscard]] constexpr bool operator!=(const optional<T> & lhs, const dtl::base_optional<U> & rhs) {
-	const bool lhv = lhs.has_value();
-	return lhv != rhs.has_value() || (lhv && dtl::ne_v(*lhs, *rhs));
+	return dtl::ne_opt(lhs, rhs);
 }
 template <typename T, typename U>
 [[nodiscard]] constexpr bool operator!=(const dtl::base_optional<T> & lhs, const optional<U> & rhs) {
-	const bool lhv = lhs.has_value();
-	return lhv != rhs.has_value() || (lhv && dtl::ne_v(*lhs, *rhs));
+	return dtl::ne_opt(lhs, rhs);
 }
 
 template <typename T, typename U>
 [[nodiscard]] constexpr bool operator<(const optional<T> & lhs, const optional<U> & rhs) {
-	return rhs.has_value() && (!lhs.has_value() || dtl::lt_v(*lhs, *rhs));
+	return dtl::lt_opt(lhs, rhs);
 }
 template <typename T, typename U>
 [[nodiscard]] constexpr bool operator<(const optional<T> & lhs, const dtl::base_optional<U> & rhs) {
-	return rhs.has_value() && (!lhs.has_value() || dtl::lt_v(*lhs, *rhs));
+	return dtl::lt_opt(lhs, rhs);
 }
 template <typename T, typename U>
 [[nodiscard]] constexpr bool operator<(const dtl::base_optional<T> & lhs, const optional<U> & rhs) {
-	return rhs.has_value() && (!lhs.has_value() || dtl::lt_v(*lhs, *rhs));
+	return dtl::lt_opt(lhs, rhs);
 }
 
 template <typename T, typename U>
 [[nodiscard]] constexpr bool operator>(const optional<T> & lhs, const optional<U> & rhs) {
-	return lhs.has_value() && (!rhs.has_value() || dtl::gt_v(*lhs, *rhs));
+	return dtl::gt_opt(lhs, rhs);
 }
 template <typename T, typename U>
 [[nodiscard]] constexpr bool operator>(const optional<T> & lhs, const dtl::base_optional<U> & rhs) {
-	return lhs.has_value() && (!rhs.has_value() || dtl::gt_v(*lhs, *rhs));
+	return dtl::gt_opt(lhs, rhs);
 }
 template <typename T, typename U>
 [[nodiscard]] constexpr bool operator>(const dtl::base_optional<T> & lhs, const optional<U> & rhs) {
-	return lhs.has_value() && (!rhs.has_value() || dtl::gt_v(*lhs, *rhs));
+	return dtl::gt_opt(lhs, rhs);
 }
 
 template <typename T, typename U>
 [[nodiscard]] constexpr bool operator<=(const optional<T> & lhs, const optional<U> & rhs) {
-	return !lhs.has_value() || (rhs.has_value() && dtl::le_v(*lhs, *rhs));
+	return dtl::le_opt(lhs, rhs);
 }
 template <typename T, typename U>
 [[nodiscard]] constexpr bool operator<=(const optional<T> & lhs, const dtl::base_optional<U> & rhs) {
-	return !lhs.has_value() || (rhs.has_value() && dtl::le_v(*lhs, *rhs));
+	return dtl::le_opt(lhs, rhs);
 }
 template <typename T, typename U>
 [[nodiscard]] constexpr bool operator<=(const dtl::base_optional<T> & lhs, const optional<U> & rhs) {
-	return !lhs.has_value() || (rhs.has_value() && dtl::le_v(*lhs, *rhs));
+	return dtl::le_opt(lhs, rhs);
 }
 
 template <typename T, typename U>
 [[nodiscard]] constexpr bool operator>=(const optional<T> & lhs, const optional<U> & rhs) {
-	return !rhs.has_value() || (lhs.has_value() && dtl::ge_v(*lhs, *rhs));
+	return dtl::ge_opt(lhs, rhs);
 }
 template <typename T, typename U>
 [[nodiscard]] constexpr bool operator>=(const optional<T> & lhs, const dtl::base_optional<U> & rhs) {
-	return !rhs.has_value() || (lhs.has_value() && dtl::ge_v(*lhs, *rhs));
+	return dtl::ge_opt(lhs, rhs);
 }
 template <typename T, typename U>
 [[nodiscard]] constexpr bool operator>=(const dtl::base_optional<T> & lhs, const optional<U> & rhs) {
-	return !rhs.has_value() || (lhs.has_value() && dtl::ge_v(*lhs, *rhs));
+	return dtl::ge_opt(lhs, rhs);
 }
 
-#ifdef OPTIONAL_THREE_WAY
-template <typename T,  typename U>
-	requires dtl::tw_comparable<T, U>
-[[nodiscard]] constexpr std::compare_three_way_result_t<T, U>
-operator<=>(const optional<T> & lhs, const optional<U> & rhs) {
-	const bool lhv = lhs.has_value();
-	const bool rhv = rhs.has_value();
-	return lhs && rhv ? *lhs <=> *rhs : lhv <=> rhv;
-}
-template <typename T,  typename U>
-	requires dtl::tw_comparable<T, U>
-[[nodiscard]] constexpr std::compare_three_way_result_t<T, U>
-operator<=>(const optional<T> & lhs, const dtl::base_optional<U> & rhs) {
-	const bool lhv = lhs.has_value();
-	const bool rhv = rhs.has_value();
-	return lhs && rhv ? *lhs <=> *rhs : lhv <=> rhv;
-}
-#endif
-
 // [optional.nullops]
 template <typename T>
 [[nodiscard]] constexpr bool operator==(const optional<T> & o, std::nullopt_t) noexcept {
@@ -861,87 +2013,79 @@ template <typename T>
 
 // [optional.comp_with_t]
 template <typename T, typename U>
-	requires (dtl::eq_comparable<T, U> || dtl::ne_comparable<T, U>) &&
-	         (!dtl::optional_related<U>)
+	requires (!dtl::optional_related<U>) &&
+	         (dtl::eq_comparable<T, U> || dtl::ne_comparable<T, U>)
 [[nodiscard]] constexpr bool operator==(const optional<T> & lhs, const U & rhs) {
-	return lhs.has_value() && dtl::eq_v(*lhs, rhs);
+	return dtl::engaged_and<U>(lhs, [&](const auto & v) { return dtl::eq_v(v, rhs); });
 }
 template <typename U, typename T>
-	requires (dtl::eq_comparable<U, T> || dtl::ne_comparable<U, T>) &&
-	         (!dtl::optional_related<U>)
+	requires (!dtl::optional_related<U>) &&
+	         (dtl::eq_comparable<U, T> || dtl::ne_comparable<U, T>)
 [[nodiscard]] constexpr bool operator==(const U & lhs, const optional<T> & rhs) {
-	return rhs.has_value() && dtl::eq_v(lhs, *rhs);
+	return dtl::engaged_and<U>(rhs, [&](const auto & v) { return dtl::eq_v(lhs, v); });
 }
 
 template <typename T, typename U>
-	requires (dtl::ne_comparable<T, U> || dtl::eq_comparable<T, U>) &&
-	         (!dtl::optional_related<U>)
+	requires (!dtl::optional_related<U>) &&
+	         (dtl::ne_comparable<T, U> || dtl::eq_comparable<T, U>)
 [[nodiscard]] constexpr bool operator!=(const optional<T> & lhs, const U & rhs) {
-	return !lhs.has_value() || dtl::ne_v(*lhs, rhs);
+	return dtl::disengaged_or<U>(lhs, [&](const auto & v) { return dtl::ne_v(v, rhs); });
 }
 template <typename U, typename T>
-	requires (dtl::ne_comparable<U, T> || dtl::eq_comparable<U, T>) &&
-	         (!dtl::optional_related<U>)
+	requires (!dtl::optional_related<U>) &&
+	         (dtl::ne_comparable<U, T> || dtl::eq_comparable<U, T>)
 [[nodiscard]] constexpr bool operator!=(const U & lhs, const optional<T> & rhs) {
-	return !rhs.has_value() || dtl::ne_v(lhs, *rhs);
+	return dtl::disengaged_or<U>(rhs, [&](const auto & v) { return dtl::ne_v(lhs, v); });
 }
 
 template <typename T, typename U>
-	requires dtl::lt_comparable<T, U> && (!dtl::optional_related<U>)
+	requires (!dtl::optional_related<U>) && dtl::lt_comparable<T, U>
 [[nodiscard]] constexpr bool operator<(const optional<T> & lhs, const U & rhs) {
-	return !lhs.has_value() || dtl::lt_v(*lhs, rhs);
+	return dtl::disengaged_or<U>(lhs, [&](const auto & v) { return dtl::lt_v(v, rhs); });
 }
 template <typename U, typename T>
-	requires dtl::lt_comparable<U, T> && (!dtl::optional_related<U>)
+	requires (!dtl::optional_related<U>) && dtl::lt_comparable<U, T>
 [[nodiscard]] constexpr bool operator<(const U & lhs, const optional<T> & rhs) {
-	return rhs.has_value() && dtl::lt_v(lhs, *rhs);
+	return dtl::engaged_and<U>(rhs, [&](const auto & v) { return dtl::lt_v(lhs, v); });
 }
 
 template <typename T, typename U>
-	requires (dtl::gt_comparable<T, U> || dtl::lt_comparable<U, T>) &&
-	         (!dtl::optional_related<U>)
+	requires (!dtl::optional_related<U>) &&
+	         (dtl::gt_comparable<T, U> || dtl::lt_comparable<U, T>)
 [[nodiscard]] constexpr bool operator>(const optional<T> & lhs, const U & rhs) {
-	return lhs.has_value() && dtl::gt_v(*lhs, rhs);
+	return dtl::engaged_and<U>(lhs, [&](const auto & v) { return dtl::gt_v(v, rhs); });
 }
 template <typename U, typename T>
-	requires (dtl::gt_comparable<U, T> || dtl::lt_comparable<T, U>) &&
-	         (!dtl::optional_related<U>)
+	requires (!dtl::optional_related<U>) &&
+	         (dtl::gt_comparable<U, T> || dtl::lt_comparable<T, U>)
 [[nodiscard]] constexpr bool operator>(const U & lhs, const optional<T> & rhs) {
-	return !rhs.has_value() || dtl::gt_v(lhs, *rhs);
+	return dtl::disengaged_or<U>(rhs, [&](const auto & v) { return dtl::gt_v(lhs, v); });
 }
 
 template <typename T, typename U>
-	requires (dtl::le_comparable<T, U> || dtl::lt_comparable<U, T>) &&
-	         (!dtl::optional_related<U>)
+	requires (!dtl::optional_related<U>) &&
+	         (dtl::le_comparable<T, U> || dtl::lt_comparable<U, T>)
 [[nodiscard]] constexpr bool operator<=(const optional<T> & lhs, const U & rhs) {
-	return !lhs.has_value() || dtl::le_v(*lhs, rhs);
+	return dtl::disengaged_or<U>(lhs, [&](const auto & v) { return dtl::le_v(v, rhs); });
 }
 template <typename U, typename T>
-	requires (dtl::le_comparable<U, T> || dtl::lt_comparable<T, U>) &&
-	         (!dtl::optional_related<U>)
+	requires (!dtl::optional_related<U>) &&
+	         (dtl::le_comparable<U, T> || dtl::lt_comparable<T, U>)
 [[nodiscard]] constexpr bool operator<=(const U & lhs, const optional<T> & rhs) {
-	return rhs.has_value() && dtl::le_v(lhs, *rhs);
+	return dtl::engaged_and<U>(rhs, [&](const auto & v) { return dtl::le_v(lhs, v); });
 }
 
 template <typename T, typename U>
-	requires (dtl::ge_comparable<T, U> || dtl::lt_comparable<T, U>) &&
-	         (!dtl::optional_related<U>)
+	requires (!dtl::optional_related<U>) &&
+	         (dtl::ge_comparable<T, U> || dtl::lt_comparable<T, U>)
 [[nodiscard]] constexpr bool operator>=(const optional<T> & lhs, const U & rhs) {
-	return lhs.has_value() && dtl::ge_v(*lhs, rhs);
+	return dtl::engaged_and<U>(lhs, [&](const auto & v) { return dtl::ge_v(v, rhs); });
 }
 template <typename U, typename T>
-	requires (dtl::ge_comparable<U, T> || dtl::lt_comparable<U, T>) &&
-	         (!dtl::optional_related<U>)
+	requires (!dtl::optional_related<U>) &&
+	         (dtl::ge_comparable<U, T> || dtl::lt_comparable<U, T>)
 [[nodiscard]] constexpr bool operator>=(const U & lhs, const optional<T> & rhs) {
-	return !rhs.has_value() || dtl::ge_v(lhs, *rhs);
-}
-
-#ifdef OPTIONAL_THREE_WAY
-template <typename T,  typename U>
-	requires dtl::tw_comparable<T, U>
-[[nodiscard]] constexpr std::compare_three_way_result_t<T, U>
-operator<=>(const optional<T> & lhs, const U & rhs) {
-	return lhs.has_value() ? *lhs <=> rhs : std::strong_ordering::less;
+	return dtl::disengaged_or<U>(rhs, [&](const auto & v) { return dtl::ge_v(lhs, v); });
 }
 #endif
 
@@ -999,6 +2143,15 @@ using pointer_t = typename optional<T>::pointer_type;
 template <typename T>
 using const_pointer_t = typename optional<T>::pointer_const_type;
 
+// optional<T &> is a nullable pointer: nothing but its T *, which is null if disengaged. This
+// layout is part of the interface, optional_span.hpp views arrays of pointers through it.
+template <typename T>
+concept pointer_layout = std::is_standard_layout_v<optional<T &>> && std::is_trivially_copyable_v<optional<T &>> &&
+                         sizeof(optional<T &>) == sizeof(T *) && alignof(optional<T &>) == alignof(T *);
+
+static_assert(pointer_layout<int> && pointer_layout<const int> && pointer_layout<optional<int>>);
+static_assert(optional<int &>{}.get_ptr() == nullptr && !optional<int &>{ none }.has_value());
+
 } // non-exported namespace dtl
 OPTIONAL_NOEXPORT_END
 } // namespace OPTIONAL_NAMESPACE
@@ -1067,8 +2220,16 @@ struct hash<::OPTIONAL_NAMESPACE::optional<T>> {
 	using result_type OPTIONAL_DEPRECATED   = size_t;
 	using _h = hash<::OPTIONAL_NAMESPACE::dtl::base_optional<T>>;
 	[[nodiscard]] size_t operator()(const ::OPTIONAL_NAMESPACE::optional<T> & o) const noexcept(
-		noexcept(_h{}(o))) {
-		return _h{}(o);
+		noexcept(_h{}(declval<const ::OPTIONAL_NAMESPACE::dtl::base_optional<T> &>()))) {
+		if constexpr (::OPTIONAL_NAMESPACE::dtl::branchless<T>) {
+			// the hash of either state is computed, the engagement state selects by mask
+			const size_t engaged = size_t{ 0 } - static_cast<size_t>(o.has_value());
+			const size_t payload = hash<remove_const_t<T>>{}(::OPTIONAL_NAMESPACE::dtl::payload_or_zero(o));
+			return (payload & engaged) | (_h{}(::OPTIONAL_NAMESPACE::dtl::base_optional<T>{}) & ~engaged);
+		} else if constexpr (::OPTIONAL_NAMESPACE::dtl::niche_type<T>)
+			return _h{}(static_cast<::OPTIONAL_NAMESPACE::dtl::base_optional<T>>(o));
+		else
+			return _h{}(o);
 	}
 };
 
@@ -1085,8 +2246,16 @@ struct hash<::OPTIONAL_NAMESPACE::optional<T &>> {
 	}
 };
 
+// [allocator.uses.trait], containers pass their allocator down to the payload
+OPTIONAL_EXPORT
+template <typename T, typename Alloc>
+	requires (!::OPTIONAL_NAMESPACE::dtl::niche_type<T>)
+struct uses_allocator<::OPTIONAL_NAMESPACE::optional<T>, Alloc> : uses_allocator<T, Alloc> {};
+
 } // namespace std
 
+#undef OPTIONAL_TALLY
+#undef OPTIONAL_TALLY_IF
 #undef OPTIONAL_THREE_WAY
 #undef OPTIONAL_CONSTEVAL
 #undef OPTIONAL_DEPRECATED
@@ -0,0 +1,443 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#pragma push_macro("OPTIONAL_NAMESPACE")
+#include "optional.hpp"
+#pragma pop_macro("OPTIONAL_NAMESPACE")
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+#ifndef OPTIONAL_NAMESPACE
+#define OPTIONAL_NAMESPACE boost
+#endif
+
+namespace OPTIONAL_NAMESPACE {
+namespace {
+namespace dtl {
+
+// random access iterators to mutable optional<T> objects, T being no reference
+template <typename It>
+concept optional_iterator =
+	std::random_access_iterator<It> && std::same_as<std::iter_reference_t<It>, std::iter_value_t<It> &> &&
+	std::same_as<std::iter_value_t<It>, optional<typename std::iter_value_t<It>::value_type>> &&
+	!std::is_reference_v<typename std::iter_value_t<It>::value_type>;
+
+template <typename It>
+using payload_t = typename std::iter_value_t<It>::value_type;
+
+// the payloads of a range of engaged optionals, as a range of T
+template <typename It>
+class payload_iterator {
+	It it_;
+
+public:
+	using iterator_category = std::random_access_iterator_tag;
+	using value_type        = payload_t<It>;
+	using difference_type   = std::iter_difference_t<It>;
+	using reference         = value_type &;
+	using pointer           = value_type *;
+
+	payload_iterator() = default;
+	explicit payload_iterator(It it) : it_(it) {}
+
+	reference operator*() const { return **it_; }
+	pointer operator->() const { return std::addressof(**it_); }
+	reference operator[](difference_type n) const { return *it_[n]; }
+
+	payload_iterator & operator++() { ++it_; return *this; }
+	payload_iterator & operator--() { --it_; return *this; }
+	payload_iterator operator++(int) { return payload_iterator{ it_++ }; }
+	payload_iterator operator--(int) { return payload_iterator{ it_-- }; }
+	payload_iterator & operator+=(difference_type n) { it_ += n; return *this; }
+	payload_iterator & operator-=(difference_type n) { it_ -= n; return *this; }
+
+	friend payload_iterator operator+(payload_iterator i, difference_type n) { return i += n; }
+	friend payload_iterator operator+(difference_type n, payload_iterator i) { return i += n; }
+	friend payload_iterator operator-(payload_iterator i, difference_type n) { return i -= n; }
+	friend difference_type operator-(const payload_iterator & lhs, const payload_iterator & rhs) {
+		return lhs.it_ - rhs.it_;
+	}
+	friend bool operator==(const payload_iterator & lhs, const payload_iterator & rhs) { return lhs.it_ == rhs.it_; }
+	friend auto operator<=>(const payload_iterator & lhs, const payload_iterator & rhs) { return lhs.it_ <=> rhs.it_; }
+};
+
+// pattern-defeating quicksort after Orson Peters: introsort with a median-of-3 or ninther pivot,
+// insertion sort for small and nearly sorted partitions, equal-key partitions split off once,
+// patterns of bad pivots broken up by swaps, and heapsort as the last resort
+inline constexpr std::ptrdiff_t insertion_sort_threshold = 24;
+inline constexpr std::ptrdiff_t ninther_threshold        = 128;
+inline constexpr std::ptrdiff_t partial_insertion_limit  = 8;
+
+template <typename It, typename Comp>
+void insertion_sort(It first, It last, Comp & comp) {
+	if (first == last)
+		return;
+	for (It current = first + 1; current != last; ++current) {
+		if (comp(*current, *(current - 1))) {
+			auto tmp = std::move(*current);
+			It sift  = current;
+			do {
+				*sift = std::move(*(sift - 1));
+				--sift;
+			} while (sift != first && comp(tmp, *(sift - 1)));
+			*sift = std::move(tmp);
+		}
+	}
+}
+
+// an element not greater than all of [first, last) precedes first, it stops the sifts
+template <typename It, typename Comp>
+void unguarded_insertion_sort(It first, It last, Comp & comp) {
+	if (first == last)
+		return;
+	for (It current = first + 1; current != last; ++current) {
+		if (comp(*current, *(current - 1))) {
+			auto tmp = std::move(*current);
+			It sift  = current;
+			do {
+				*sift = std::move(*(sift - 1));
+				--sift;
+			} while (comp(tmp, *(sift - 1)));
+			*sift = std::move(tmp);
+		}
+	}
+}
+
+// gives up when more than a few elements had to be moved
+template <typename It, typename Comp>
+[[nodiscard]] bool partial_insertion_sort(It first, It last, Comp & comp) {
+	if (first == last)
+		return true;
+	std::ptrdiff_t moves = 0;
+	for (It current = first + 1; current != last; ++current) {
+		if (comp(*current, *(current - 1))) {
+			auto tmp = std::move(*current);
+			It sift  = current;
+			do {
+				*sift = std::move(*(sift - 1));
+				--sift;
+			} while (sift != first && comp(tmp, *(sift - 1)));
+			*sift = std::move(tmp);
+			moves += current - sift;
+		}
+		if (moves > partial_insertion_limit)
+			return false;
+	}
+	return true;
+}
+
+template <typename It, typename Comp>
+void sort2(It a, It b, Comp & comp) {
+	if (comp(*b, *a))
+		std::iter_swap(a, b);
+}
+
+template <typename It, typename Comp>
+void sort3(It a, It b, It c, Comp & comp) {
+	sort2(a, b, comp);
+	sort2(b, c, comp);
+	sort2(a, b, comp);
+}
+
+// partitions around the pivot *first, elements equal to it go right. Returns the position of
+// the pivot and whether there was nothing to swap.
+template <typename It, typename Comp>
+[[nodiscard]] std::pair<It, bool> partition_right(It first, It last, Comp & comp) {
+	auto pivot = std::move(*first);
+	It lo      = first;
+	It hi      = last;
+	while (comp(*++lo, pivot))
+		;
+	if (lo - 1 == first)
+		while (lo < hi && !comp(*--hi, pivot))
+			;
+	else
+		while (!comp(*--hi, pivot))
+			;
+
+	const bool partitioned = lo >= hi;
+	while (lo < hi) {
+		std::iter_swap(lo, hi);
+		while (comp(*++lo, pivot))
+			;
+		while (!comp(*--hi, pivot))
+			;
+	}
+	It pivot_pos = lo - 1;
+	*first       = std::move(*pivot_pos);
+	*pivot_pos   = std::move(pivot);
+	return { pivot_pos, partitioned };
+}
+
+// partitions around the pivot *first, elements equal to it go left. Used when the pivot equals
+// the element preceding the range, so the left part is final.
+template <typename It, typename Comp>
+[[nodiscard]] It partition_left(It first, It last, Comp & comp) {
+	auto pivot = std::move(*first);
+	It lo      = first;
+	It hi      = last;
+	while (comp(pivot, *--hi))
+		;
+	if (hi + 1 == last)
+		while (lo < hi && !comp(pivot, *++lo))
+			;
+	else
+		while (!comp(pivot, *++lo))
+			;
+
+	while (lo < hi) {
+		std::iter_swap(lo, hi);
+		while (comp(pivot, *--hi))
+			;
+		while (!comp(pivot, *++lo))
+			;
+	}
+	*first = std::move(*hi);
+	*hi    = std::move(pivot);
+	return hi;
+}
+
+template <typename It, typename Comp>
+void pdqsort_loop(It first, It last, Comp & comp, int bad_allowed, bool leftmost) {
+	for (;;) {
+		const auto size = last - first;
+		if (size < insertion_sort_threshold) {
+			if (leftmost)
+				insertion_sort(first, last, comp);
+			else
+				unguarded_insertion_sort(first, last, comp);
+			return;
+		}
+
+		const auto half = size / 2;
+		if (size > ninther_threshold) {
+			sort3(first, first + half, last - 1, comp);
+			sort3(first + 1, first + (half - 1), last - 2, comp);
+			sort3(first + 2, first + (half + 1), last - 3, comp);
+			sort3(first + (half - 1), first + half, first + (half + 1), comp);
+			std::iter_swap(first, first + half);
+		} else {
+			sort3(first + half, first, last - 1, comp);
+		}
+
+		// many equal keys: the pivot equals the preceding element, everything equal to it is final
+		if (!leftmost && !comp(*(first - 1), *first)) {
+			first = partition_left(first, last, comp) + 1;
+			continue;
+		}
+
+		const auto [pivot_pos, partitioned] = partition_right(first, last, comp);
+		const auto left_size                = pivot_pos - first;
+		const auto right_size               = last - (pivot_pos + 1);
+
+		if (left_size < size / 8 || right_size < size / 8) {
+			if (--bad_allowed == 0) {
+				std::make_heap(first, last, comp);
+				std::sort_heap(first, last, comp);
+				return;
+			}
+			if (left_size >= insertion_sort_threshold) {
+				std::iter_swap(first, first + left_size / 4);
+				std::iter_swap(pivot_pos - 1, pivot_pos - left_size / 4);
+				if (left_size > ninther_threshold) {
+					std::iter_swap(first + 1, first + (left_size / 4 + 1));
+					std::iter_swap(first + 2, first + (left_size / 4 + 2));
+					std::iter_swap(pivot_pos - 2, pivot_pos - (left_size / 4 + 1));
+					std::iter_swap(pivot_pos - 3, pivot_pos - (left_size / 4 + 2));
+				}
+			}
+			if (right_size >= insertion_sort_threshold) {
+				std::iter_swap(pivot_pos + 1, pivot_pos + (1 + right_size / 4));
+				std::iter_swap(last - 1, last - right_size / 4);
+				if (right_size > ninther_threshold) {
+					std::iter_swap(pivot_pos + 2, pivot_pos + (2 + right_size / 4));
+					std::iter_swap(pivot_pos + 3, pivot_pos + (3 + right_size / 4));
+					std::iter_swap(last - 2, last - (1 + right_size / 4));
+					std::iter_swap(last - 3, last - (2 + right_size / 4));
+				}
+			}
+		} else if (partitioned && partial_insertion_sort(first, pivot_pos, comp) &&
+		           partial_insertion_sort(pivot_pos + 1, last, comp)) {
+			return;
+		}
+
+		pdqsort_loop(first, pivot_pos, comp, bad_allowed, leftmost);
+		first    = pivot_pos + 1;
+		leftmost = false;
+	}
+}
+
+template <typename It, typename Comp>
+void pdqsort(It first, It last, Comp comp) {
+	const auto size = static_cast<std::size_t>(last - first);
+	if (size > 1)
+		pdqsort_loop(first, last, comp, std::bit_width(size), true);
+}
+
+// integers are radix sorted by default, other comparisons than ascending order fall back to pdqsort
+template <typename T, typename Comp>
+concept radix_sortable = std::integral<T> && !std::same_as<T, bool> &&
+                         (std::same_as<Comp, std::less<>> || std::same_as<Comp, std::less<T>> ||
+                          std::same_as<Comp, std::ranges::less>);
+
+// below this many engaged elements, building the histograms costs more than it saves
+inline constexpr std::size_t radix_sort_threshold = 256;
+
+// flipping the sign bit orders signed integers like their unsigned keys
+template <typename T>
+[[nodiscard]] constexpr std::make_unsigned_t<T> radix_key(T value) noexcept {
+	using key = std::make_unsigned_t<T>;
+	if constexpr (std::is_signed_v<T>)
+		return static_cast<key>(static_cast<key>(value) ^ (key{ 1 } << (8 * sizeof(T) - 1)));
+	else
+		return value;
+}
+
+template <typename T>
+[[nodiscard]] constexpr T from_radix_key(std::make_unsigned_t<T> key) noexcept {
+	if constexpr (std::is_signed_v<T>)
+		return static_cast<T>(static_cast<decltype(key)>(key ^ (decltype(key){ 1 } << (8 * sizeof(T) - 1))));
+	else
+		return key;
+}
+
+// least significant digit first, one byte per pass. The histograms of all bytes are gathered in
+// a single pass, bytes which are the same in all keys are skipped. Returns the buffer holding
+// the sorted keys, either keys or scratch.
+template <typename Key>
+[[nodiscard]] Key * radix_sort(Key * keys, Key * scratch, std::size_t n) {
+	constexpr std::size_t digits = sizeof(Key);
+	std::array<std::array<std::size_t, 256>, digits> counts{};
+	for (std::size_t i = 0; i < n; ++i)
+		for (std::size_t d = 0; d < digits; ++d)
+			++counts[d][(keys[i] >> (8 * d)) & 0xFF];
+
+	for (std::size_t d = 0; d < digits; ++d) {
+		auto & count = counts[d];
+		if (count[(keys[0] >> (8 * d)) & 0xFF] == n)
+			continue;
+		std::size_t offset = 0;
+		for (auto & c : count)
+			offset += std::exchange(c, offset);
+		for (std::size_t i = 0; i < n; ++i)
+			scratch[count[(keys[i] >> (8 * d)) & 0xFF]++] = keys[i];
+		std::swap(keys, scratch);
+	}
+	return keys;
+}
+
+// gathers the payloads without branching on the states, sorts them, and writes back the nones
+// followed by the sorted payloads. Radix sort is stable, equal integers are indistinguishable.
+template <typename It>
+void radix_sort_optionals(It first, It last) {
+	using T         = payload_t<It>;
+	using key       = std::make_unsigned_t<T>;
+	const auto size = static_cast<std::size_t>(last - first);
+	auto buffer     = std::make_unique_for_overwrite<key[]>(2 * size);
+
+	std::size_t engaged = 0;
+	for (It it = first; it != last; ++it) {
+		buffer[engaged] = radix_key(dtl::payload_or_zero(*it));
+		engaged += it->has_value();
+	}
+	const key * sorted = radix_sort(buffer.get(), buffer.get() + size, engaged);
+
+	It it = first;
+	for (const It nones = first + static_cast<std::ptrdiff_t>(size - engaged); it != nones; ++it)
+		it->reset();
+	for (std::size_t i = 0; i < engaged; ++i, ++it)
+		it->emplace(from_radix_key<T>(sorted[i]));
+}
+
+} // non-exported namespace dtl
+} // anonymous namespace
+
+// moves the disengaged optionals in [first, last) to the front and returns the first engaged
+// one. The engaged optionals keep their relative order, all nones are equal anyway.
+template <typename It>
+	requires dtl::optional_iterator<It>
+It partition_none(It first, It last) {
+	It engaged = last;
+	for (It it = last; it != first;) {
+		if ((--it)->has_value() && --engaged != it)
+			*engaged = std::move(*it);
+	}
+	for (It it = first; it != engaged; ++it)
+		it->reset();
+	return engaged;
+}
+
+namespace {
+namespace dtl {
+
+template <typename It, typename Comp>
+void sort_optionals(It first, It last, Comp & comp, bool stable) {
+	if constexpr (radix_sortable<payload_t<It>, Comp>) {
+		if (static_cast<std::size_t>(last - first) >= radix_sort_threshold)
+			return radix_sort_optionals(first, last);
+	}
+	const payload_iterator<It> engaged{ partition_none(first, last) };
+	if (stable)
+		std::stable_sort(engaged, payload_iterator<It>{ last }, std::ref(comp));
+	else
+		pdqsort(engaged, payload_iterator<It>{ last }, std::ref(comp));
+}
+
+} // non-exported namespace dtl
+} // anonymous namespace
+
+// sorts [first, last) into the order of optional's operator<, nones first, with the payloads
+// ordered by comp: partitions the nones to the front and sorts the engaged payloads by radix
+// sort if they are integers in ascending order, by pdqsort otherwise. Not stable.
+template <typename It, typename Comp = std::less<>>
+	requires dtl::optional_iterator<It> &&
+	         std::strict_weak_order<Comp &, dtl::payload_t<It> &, dtl::payload_t<It> &>
+void sort_optionals(It first, It last, Comp comp = {}) {
+	dtl::sort_optionals(first, last, comp, false);
+}
+
+// as sort_optionals, engaged elements with equal payloads keep their relative order. Payloads
+// other than integers in ascending order are merge sorted.
+template <typename It, typename Comp = std::less<>>
+	requires dtl::optional_iterator<It> &&
+	         std::strict_weak_order<Comp &, dtl::payload_t<It> &, dtl::payload_t<It> &>
+void stable_sort_optionals(It first, It last, Comp comp = {}) {
+	dtl::sort_optionals(first, last, comp, true);
+}
+
+template <std::ranges::random_access_range R>
+	requires dtl::optional_iterator<std::ranges::iterator_t<R>>
+std::ranges::borrowed_iterator_t<R> partition_none(R && r) {
+	return partition_none(std::ranges::begin(r), std::ranges::end(r));
+}
+
+template <std::ranges::random_access_range R, typename Comp = std::less<>>
+	requires dtl::optional_iterator<std::ranges::iterator_t<R>> && std::ranges::common_range<R>
+void sort_optionals(R && r, Comp comp = {}) {
+	sort_optionals(std::ranges::begin(r), std::ranges::end(r), std::move(comp));
+}
+
+template <std::ranges::random_access_range R, typename Comp = std::less<>>
+	requires dtl::optional_iterator<std::ranges::iterator_t<R>> && std::ranges::common_range<R>
+void stable_sort_optionals(R && r, Comp comp = {}) {
+	stable_sort_optionals(std::ranges::begin(r), std::ranges::end(r), std::move(comp));
+}
+
+} // namespace OPTIONAL_NAMESPACE
+
+#undef OPTIONAL_NAMESPACE
@@ -0,0 +1,419 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#pragma push_macro("OPTIONAL_NAMESPACE")
+#include "optional_vector.hpp"
+#pragma pop_macro("OPTIONAL_NAMESPACE")
+
+#include <span>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#if !defined(OPTIONAL_NO_SIMD) && defined(__AVX2__)
+#  define OPTIONAL_SIMD_AVX2
+#  include <immintrin.h>
+#elif !defined(OPTIONAL_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || _M_IX86_FP >= 2)
+#  define OPTIONAL_SIMD_SSE2
+#  include <emmintrin.h>
+#endif
+
+#ifndef OPTIONAL_NAMESPACE
+#define OPTIONAL_NAMESPACE boost
+#endif
+
+namespace OPTIONAL_NAMESPACE {
+
+enum class relop { equal, not_equal, less, less_equal, greater, greater_equal };
+
+namespace {
+namespace dtl {
+
+template <relop Op, typename T, typename U>
+[[nodiscard]] constexpr bool apply_relop(const T & lhs, const U & rhs) {
+	if constexpr (Op == relop::equal)
+		return dtl::eq_v(lhs, rhs);
+	else if constexpr (Op == relop::not_equal)
+		return dtl::ne_v(lhs, rhs);
+	else if constexpr (Op == relop::less)
+		return dtl::lt_v(lhs, rhs);
+	else if constexpr (Op == relop::less_equal)
+		return dtl::le_v(lhs, rhs);
+	else if constexpr (Op == relop::greater)
+		return dtl::gt_v(lhs, rhs);
+	else
+		return dtl::ge_v(lhs, rhs);
+}
+
+// merge the payload comparison results c with the engagement bits l and r of up to 64 lanes,
+// following [optional.relops]: a disengaged optional equals another disengaged one and is
+// less than any engaged one
+template <relop Op>
+[[nodiscard]] constexpr validity_word combine(validity_word c, validity_word l, validity_word r) noexcept {
+	if constexpr (Op == relop::equal)
+		return ~(l ^ r) & (~l | c);
+	else if constexpr (Op == relop::not_equal)
+		return (l ^ r) | (l & c);
+	else if constexpr (Op == relop::less)
+		return r & (~l | c);
+	else if constexpr (Op == relop::less_equal)
+		return ~l | (r & c);
+	else if constexpr (Op == relop::greater)
+		return l & (~r | c);
+	else
+		return ~r | (l & c);
+}
+
+// payload comparison of n <= 64 lanes
+template <relop Op, typename T, typename U>
+[[nodiscard]] constexpr validity_word compare_lanes(const T * a, const U * b, std::size_t n) {
+	validity_word m = 0;
+	for (std::size_t i = 0; i < n; ++i)
+		m |= validity_word{ dtl::apply_relop<Op>(a[i], b[i]) } << i;
+	return m;
+}
+
+// payload comparison of exactly 64 lanes
+template <relop Op, typename T, typename U>
+[[nodiscard]] validity_word compare_lanes64(const T * a, const U * b) {
+	return dtl::compare_lanes<Op>(a, b, validity_bits);
+}
+
+// the engagement bits of n <= 64 optionals
+template <typename T>
+[[nodiscard]] validity_word engaged_lanes(const optional<T> * o, std::size_t n) noexcept {
+	validity_word m = 0;
+	for (std::size_t k = 0; k < n; ++k)
+		m |= validity_word{ o[k].has_value() } << k;
+	return m;
+}
+
+// the payloads of n <= 64 optionals, disengaged ones as zero
+template <typename T>
+void gather_lanes(const optional<T> * o, std::size_t n, T * out) noexcept {
+	for (std::size_t k = 0; k < n; ++k)
+		out[k] = dtl::payload_or_zero(o[k]);
+}
+
+// the payloads of exactly 64 optionals with engagement bits m
+template <typename T>
+void gather_lanes64(const optional<T> * o, validity_word, T * out) noexcept {
+	dtl::gather_lanes(o, validity_bits, out);
+}
+
+template <relop Op>
+inline constexpr bool inverted_relop = Op == relop::not_equal || Op == relop::less_equal || Op == relop::greater_equal;
+
+#if defined(OPTIONAL_SIMD_AVX2)
+
+// integer lanes: ==, > and < are native, their complements are computed by inversion
+template <relop Op, typename Int, std::size_t Lanes, typename CmpEq, typename CmpGt, typename Movemask>
+[[nodiscard]] inline validity_word compare_int_lanes64(const Int * a, const Int * b, CmpEq eq, CmpGt gt,
+                                                       Movemask movemask) noexcept {
+	validity_word m = 0;
+	for (std::size_t k = 0; k < validity_bits / Lanes; ++k) {
+		const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + k * Lanes));
+		const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + k * Lanes));
+		__m256i c;
+		if constexpr (Op == relop::equal || Op == relop::not_equal)
+			c = eq(va, vb);
+		else if constexpr (Op == relop::greater || Op == relop::less_equal)
+			c = gt(va, vb);
+		else
+			c = gt(vb, va);
+		m |= static_cast<validity_word>(movemask(c)) << (k * Lanes);
+	}
+	return inverted_relop<Op> ? ~m : m;
+}
+
+template <relop Op>
+[[nodiscard]] inline validity_word compare_lanes64(const std::int32_t * a, const std::int32_t * b) noexcept {
+	return dtl::compare_int_lanes64<Op, std::int32_t, 8>(
+		a, b, [](__m256i x, __m256i y) { return _mm256_cmpeq_epi32(x, y); },
+		[](__m256i x, __m256i y) { return _mm256_cmpgt_epi32(x, y); },
+		[](__m256i c) { return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(c))); });
+}
+
+template <relop Op>
+[[nodiscard]] inline validity_word compare_lanes64(const std::int64_t * a, const std::int64_t * b) noexcept {
+	return dtl::compare_int_lanes64<Op, std::int64_t, 4>(
+		a, b, [](__m256i x, __m256i y) { return _mm256_cmpeq_epi64(x, y); },
+		[](__m256i x, __m256i y) { return _mm256_cmpgt_epi64(x, y); },
+		[](__m256i c) { return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(c))); });
+}
+
+// floating point lanes: the predicates match the built-in operators, including NaN
+template <relop Op>
+inline constexpr int avx_predicate = Op == relop::equal      ? _CMP_EQ_OQ
+                                   : Op == relop::not_equal  ? _CMP_NEQ_UQ
+                                   : Op == relop::less       ? _CMP_LT_OQ
+                                   : Op == relop::less_equal ? _CMP_LE_OQ
+                                   : Op == relop::greater    ? _CMP_GT_OQ
+                                                             : _CMP_GE_OQ;
+
+template <relop Op>
+[[nodiscard]] inline validity_word compare_lanes64(const float * a, const float * b) noexcept {
+	validity_word m = 0;
+	for (std::size_t k = 0; k < validity_bits / 8; ++k) {
+		const __m256 c = _mm256_cmp_ps(_mm256_loadu_ps(a + k * 8), _mm256_loadu_ps(b + k * 8), avx_predicate<Op>);
+		m |= static_cast<validity_word>(static_cast<unsigned>(_mm256_movemask_ps(c))) << (k * 8);
+	}
+	return m;
+}
+
+template <relop Op>
+[[nodiscard]] inline validity_word compare_lanes64(const double * a, const double * b) noexcept {
+	validity_word m = 0;
+	for (std::size_t k = 0; k < validity_bits / 4; ++k) {
+		const __m256d c = _mm256_cmp_pd(_mm256_loadu_pd(a + k * 4), _mm256_loadu_pd(b + k * 4), avx_predicate<Op>);
+		m |= static_cast<validity_word>(static_cast<unsigned>(_mm256_movemask_pd(c))) << (k * 4);
+	}
+	return m;
+}
+
+// payloads of 4 or 8 bytes at the start of their optionals are fetched by masked gathers, which
+// load the engaged payloads only
+template <typename T>
+concept gatherable = std::is_arithmetic_v<T> && (sizeof(T) == 4 || sizeof(T) == 8) && payload_first<optional<T>>;
+
+template <typename T>
+	requires gatherable<T>
+void gather_lanes64(const optional<T> * o, validity_word m, T * out) noexcept {
+	constexpr int stride = static_cast<int>(sizeof(optional<T>));
+	if constexpr (sizeof(T) == 4) {
+		const __m256i index = _mm256_setr_epi32(0, stride, 2 * stride, 3 * stride, 4 * stride, 5 * stride, 6 * stride,
+		                                        7 * stride);
+		const __m256i bits  = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+		for (std::size_t k = 0; k < validity_bits; k += 8) {
+			const __m256i lanes = _mm256_set1_epi32(static_cast<int>((m >> k) & 0xFF));
+			const __m256i mask  = _mm256_cmpeq_epi32(_mm256_and_si256(lanes, bits), bits);
+			const __m256i v     = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(),
+			                                                  reinterpret_cast<const int *>(o + k), index, mask, 1);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + k), v);
+		}
+	} else {
+		const __m128i index = _mm_setr_epi32(0, stride, 2 * stride, 3 * stride);
+		const __m256i bits  = _mm256_setr_epi64x(1, 2, 4, 8);
+		for (std::size_t k = 0; k < validity_bits; k += 4) {
+			const __m256i lanes = _mm256_set1_epi64x(static_cast<long long>((m >> k) & 0xF));
+			const __m256i mask  = _mm256_cmpeq_epi64(_mm256_and_si256(lanes, bits), bits);
+			const __m256i v     = _mm256_mask_i32gather_epi64(_mm256_setzero_si256(),
+			                                                  reinterpret_cast<const long long *>(o + k), index, mask, 1);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + k), v);
+		}
+	}
+}
+
+#elif defined(OPTIONAL_SIMD_SSE2)
+
+template <relop Op>
+[[nodiscard]] inline validity_word compare_lanes64(const std::int32_t * a, const std::int32_t * b) noexcept {
+	validity_word m = 0;
+	for (std::size_t k = 0; k < validity_bits / 4; ++k) {
+		const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + k * 4));
+		const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + k * 4));
+		__m128i c;
+		if constexpr (Op == relop::equal || Op == relop::not_equal)
+			c = _mm_cmpeq_epi32(va, vb);
+		else if constexpr (Op == relop::greater || Op == relop::less_equal)
+			c = _mm_cmpgt_epi32(va, vb);
+		else
+			c = _mm_cmplt_epi32(va, vb);
+		m |= static_cast<validity_word>(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(c)))) << (k * 4);
+	}
+	return inverted_relop<Op> ? ~m : m;
+}
+
+template <relop Op>
+[[nodiscard]] inline __m128 sse_compare(__m128 a, __m128 b) noexcept {
+	if constexpr (Op == relop::equal)
+		return _mm_cmpeq_ps(a, b);
+	else if constexpr (Op == relop::not_equal)
+		return _mm_cmpneq_ps(a, b);
+	else if constexpr (Op == relop::less)
+		return _mm_cmplt_ps(a, b);
+	else if constexpr (Op == relop::less_equal)
+		return _mm_cmple_ps(a, b);
+	else if constexpr (Op == relop::greater)
+		return _mm_cmpgt_ps(a, b);
+	else
+		return _mm_cmpge_ps(a, b);
+}
+
+template <relop Op>
+[[nodiscard]] inline __m128d sse_compare(__m128d a, __m128d b) noexcept {
+	if constexpr (Op == relop::equal)
+		return _mm_cmpeq_pd(a, b);
+	else if constexpr (Op == relop::not_equal)
+		return _mm_cmpneq_pd(a, b);
+	else if constexpr (Op == relop::less)
+		return _mm_cmplt_pd(a, b);
+	else if constexpr (Op == relop::less_equal)
+		return _mm_cmple_pd(a, b);
+	else if constexpr (Op == relop::greater)
+		return _mm_cmpgt_pd(a, b);
+	else
+		return _mm_cmpge_pd(a, b);
+}
+
+template <relop Op>
+[[nodiscard]] inline validity_word compare_lanes64(const float * a, const float * b) noexcept {
+	validity_word m = 0;
+	for (std::size_t k = 0; k < validity_bits / 4; ++k) {
+		const __m128 c = dtl::sse_compare<Op>(_mm_loadu_ps(a + k * 4), _mm_loadu_ps(b + k * 4));
+		m |= static_cast<validity_word>(static_cast<unsigned>(_mm_movemask_ps(c))) << (k * 4);
+	}
+	return m;
+}
+
+template <relop Op>
+[[nodiscard]] inline validity_word compare_lanes64(const double * a, const double * b) noexcept {
+	validity_word m = 0;
+	for (std::size_t k = 0; k < validity_bits / 2; ++k) {
+		const __m128d c = dtl::sse_compare<Op>(_mm_loadu_pd(a + k * 2), _mm_loadu_pd(b + k * 2));
+		m |= static_cast<validity_word>(static_cast<unsigned>(_mm_movemask_pd(c))) << (k * 2);
+	}
+	return m;
+}
+
+#endif
+
+[[nodiscard]] constexpr validity_word tail_mask(std::size_t n) noexcept {
+	return n >= validity_bits ? ~validity_word{ 0 } : (validity_word{ 1 } << n) - 1;
+}
+
+// rhs == nullptr compares against the engaged scalar value s
+template <relop Op, typename T, typename U>
+void compare_columns(const T * a, const validity_word * la, std::size_t n, const U * b, const validity_word * lb,
+                     const U & s, validity_word * out) {
+	U broadcast[validity_bits];
+	if (b == nullptr)
+		for (U & x : broadcast)
+			x = s;
+	for (std::size_t w = 0, i = 0; i < n; ++w, i += validity_bits) {
+		const std::size_t count = std::min(validity_bits, n - i);
+		const U * rhs           = b ? b + i : broadcast;
+		const validity_word c   = count == validity_bits ? dtl::compare_lanes64<Op>(a + i, rhs)
+		                                                 : dtl::compare_lanes<Op>(a + i, rhs, count);
+		out[w] = dtl::combine<Op>(c, la[w], lb ? lb[w] : ~validity_word{ 0 }) & dtl::tail_mask(count);
+	}
+}
+
+// array-of-optionals form: the engagements and payloads of 64 lanes at a time are gathered into
+// bitmaps and lane buffers without branching, disengaged payloads as zero, and then compared like
+// columns. With AVX2, payloads of 4 and 8 bytes are gathered 8 or 4 at a time.
+template <relop Op, typename T, typename U>
+void compare_optionals(const optional<T> * a, std::size_t n, const optional<U> * b, const U & s,
+                       validity_word * out) {
+	T lhs[validity_bits];
+	U rhs[validity_bits];
+	if (b == nullptr)
+		for (U & x : rhs)
+			x = s;
+	for (std::size_t w = 0, i = 0; i < n; ++w, i += validity_bits) {
+		const std::size_t count = std::min(validity_bits, n - i);
+		const validity_word l = dtl::engaged_lanes(a + i, count);
+		const validity_word r = b ? dtl::engaged_lanes(b + i, count) : ~validity_word{ 0 };
+		validity_word c;
+		if (count == validity_bits) {
+			dtl::gather_lanes64(a + i, l, lhs);
+			if (b)
+				dtl::gather_lanes64(b + i, r, rhs);
+			c = dtl::compare_lanes64<Op>(lhs, rhs);
+		} else {
+			dtl::gather_lanes(a + i, count, lhs);
+			if (b)
+				dtl::gather_lanes(b + i, count, rhs);
+			c = dtl::compare_lanes<Op>(lhs, rhs, count);
+		}
+		out[w] = dtl::combine<Op>(c, l, r) & dtl::tail_mask(count);
+	}
+}
+
+template <typename F>
+decltype(auto) dispatch_relop(relop op, F && f) {
+	switch (op) {
+		case relop::equal: return f.template operator()<relop::equal>();
+		case relop::not_equal: return f.template operator()<relop::not_equal>();
+		case relop::less: return f.template operator()<relop::less>();
+		case relop::less_equal: return f.template operator()<relop::less_equal>();
+		case relop::greater: return f.template operator()<relop::greater>();
+		default: return f.template operator()<relop::greater_equal>();
+	}
+}
+
+template <typename T>
+concept batch_comparable = std::is_arithmetic_v<T> || std::is_pointer_v<T> || std::is_enum_v<T>;
+
+} // non-exported namespace dtl
+} // anonymous namespace
+
+// batch comparisons: out receives one result bit per element (validity_words(n) words, bits
+// beyond n are zero), each bit matching the corresponding scalar relational operator on optionals
+
+// columnar lhs (payloads + validity bitmap) against an engaged scalar
+template <typename T, typename U>
+	requires dtl::batch_comparable<T> && dtl::batch_comparable<U>
+void batch_compare(relop op, std::span<const T> lhs, const dtl::validity_word * lhs_validity, const U & rhs,
+                   dtl::validity_word * out) {
+	dtl::dispatch_relop(op, [&]<relop Op>() {
+		dtl::compare_columns<Op>(lhs.data(), lhs_validity, lhs.size(), static_cast<const U *>(nullptr), nullptr, rhs, out);
+	});
+}
+
+// columnar lhs against columnar rhs of the same length
+template <typename T, typename U>
+	requires dtl::batch_comparable<T> && dtl::batch_comparable<U>
+void batch_compare(relop op, std::span<const T> lhs, const dtl::validity_word * lhs_validity, std::span<const U> rhs,
+                   const dtl::validity_word * rhs_validity, dtl::validity_word * out) {
+	dtl::dispatch_relop(op, [&]<relop Op>() {
+		dtl::compare_columns<Op>(lhs.data(), lhs_validity, lhs.size(), rhs.data(), rhs_validity, U{}, out);
+	});
+}
+
+// array of optionals against an engaged scalar
+template <typename T, typename U>
+	requires dtl::batch_comparable<T> && dtl::batch_comparable<U>
+void batch_compare(relop op, std::span<const optional<T>> lhs, const U & rhs, dtl::validity_word * out) {
+	dtl::dispatch_relop(op, [&]<relop Op>() {
+		dtl::compare_optionals<Op>(lhs.data(), lhs.size(), static_cast<const optional<U> *>(nullptr), rhs, out);
+	});
+}
+
+// array of optionals against an array of optionals of the same length
+template <typename T, typename U>
+	requires dtl::batch_comparable<T> && dtl::batch_comparable<U>
+void batch_compare(relop op, std::span<const optional<T>> lhs, std::span<const optional<U>> rhs,
+                   dtl::validity_word * out) {
+	dtl::dispatch_relop(op, [&]<relop Op>() {
+		dtl::compare_optionals<Op>(lhs.data(), lhs.size(), rhs.data(), U{}, out);
+	});
+}
+
+template <typename T, typename U>
+	requires dtl::batch_comparable<T> && dtl::batch_comparable<U>
+[[nodiscard]] std::vector<dtl::validity_word> batch_compare(relop op, const optional_vector<T> & lhs, const U & rhs) {
+	std::vector<dtl::validity_word> result(dtl::validity_words(lhs.size()));
+	batch_compare(op, lhs.values(), lhs.validity().data(), rhs, result.data());
+	return result;
+}
+
+template <typename T, typename U>
+	requires dtl::batch_comparable<T> && dtl::batch_comparable<U>
+[[nodiscard]] std::vector<dtl::validity_word> batch_compare(relop op, const optional_vector<T> & lhs,
+                                                            const optional_vector<U> & rhs) {
+	std::vector<dtl::validity_word> result(dtl::validity_words(lhs.size()));
+	batch_compare(op, lhs.values(), lhs.validity().data(), rhs.values(), rhs.validity().data(), result.data());
+	return result;
+}
+
+} // namespace OPTIONAL_NAMESPACE
+
+#undef OPTIONAL_SIMD_AVX2
+#undef OPTIONAL_SIMD_SSE2
+#undef OPTIONAL_NAMESPACE
@@ -0,0 +1,169 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#pragma push_macro("OPTIONAL_NAMESPACE")
+#include "optional.hpp"
+#pragma pop_macro("OPTIONAL_NAMESPACE")
+
+#include <coroutine>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifndef OPTIONAL_NAMESPACE
+#define OPTIONAL_NAMESPACE boost
+#endif
+
+// functions returning optional<T> may be coroutines: 'co_await o' on any optional o yields *o if
+// o is engaged and otherwise ends the coroutine with none, 'co_return v' returns v.
+//
+//   optional<int> sum(std::string_view a, std::string_view b) {
+//       co_return co_await parse(a) + co_await parse(b);
+//   }
+//
+// The coroutine runs to completion within the call, it never suspends. Its frame is therefore
+// never seen outside of the call, which lets optimizers elide its allocation. Where they don't,
+// frames are recycled through a small per-thread cache.
+
+namespace OPTIONAL_NAMESPACE {
+namespace {
+namespace dtl {
+
+// per thread free lists of coroutine frames, by size in steps of 64 bytes up to 1 KiB
+class frame_cache {
+	static constexpr std::size_t granularity = 64;
+	static constexpr std::size_t classes     = 16;
+	static constexpr std::size_t depth       = 8; // cached frames per size class
+
+	struct frame {
+		frame * next;
+	};
+	frame * free_[classes]      = {};
+	std::size_t cached_[classes] = {};
+
+	[[nodiscard]] static constexpr std::size_t size_class(std::size_t size) noexcept {
+		return (size - 1) / granularity;
+	}
+
+public:
+	frame_cache() = default;
+	frame_cache(const frame_cache &) = delete;
+	~frame_cache() {
+		for (frame * f : free_)
+			while (f)
+				::operator delete(std::exchange(f, f->next));
+	}
+
+	[[nodiscard]] static frame_cache & instance() noexcept {
+		static thread_local frame_cache cache;
+		return cache;
+	}
+
+	[[nodiscard]] void * allocate(std::size_t size) {
+		const std::size_t c = size_class(size);
+		if (c >= classes)
+			return ::operator new(size);
+		if (frame * f = free_[c]) {
+			free_[c] = f->next;
+			--cached_[c];
+			return f;
+		}
+		return ::operator new((c + 1) * granularity);
+	}
+
+	void deallocate(void * p, std::size_t size) noexcept {
+		const std::size_t c = size_class(size);
+		if (c >= classes || cached_[c] == depth)
+			return ::operator delete(p);
+		free_[c] = ::new (p) frame{ free_[c] };
+		++cached_[c];
+	}
+};
+
+template <typename T>
+class optional_promise;
+
+// the result of get_return_object, converted to optional<T> when the coroutine returns to its
+// caller. It is neither copied nor moved and thereby stays where the promise can find it.
+template <typename T>
+class optional_return {
+	friend class optional_promise<T>;
+
+	optional<T> value_;
+
+public:
+	explicit optional_return(optional_promise<T> & promise) noexcept { promise.return_ = this; }
+	optional_return(const optional_return &) = delete;
+	optional_return & operator=(const optional_return &) = delete;
+
+	operator optional<T>() noexcept(std::is_nothrow_move_constructible_v<T>) {
+		return static_cast<optional<T> &&>(value_);
+	}
+};
+
+template <typename O>
+class optional_awaiter {
+	// a temporary operand dies with the co_await expression, its payload is moved out instead of
+	// referenced. Lvalue operands and optional references yield references.
+	using payload = decltype(*std::declval<O>());
+	using result  = std::conditional_t<std::is_rvalue_reference_v<payload>, std::remove_cvref_t<payload>, payload>;
+
+	O && o_;
+
+public:
+	explicit optional_awaiter(O && o) noexcept : o_(static_cast<O &&>(o)) {}
+
+	[[nodiscard]] bool await_ready() const noexcept { return o_.has_value(); }
+	// none ends the coroutine, and the call with it, with the none in the return object
+	void await_suspend(std::coroutine_handle<> coroutine) const noexcept { coroutine.destroy(); }
+	[[nodiscard]] result await_resume() const noexcept(std::is_nothrow_constructible_v<result, payload>) {
+		return *static_cast<O &&>(o_);
+	}
+};
+
+template <typename T>
+class optional_promise {
+	friend class optional_return<T>;
+
+	optional_return<T> * return_ = nullptr;
+
+public:
+	[[nodiscard]] static void * operator new(std::size_t size) { return frame_cache::instance().allocate(size); }
+	static void operator delete(void * p, std::size_t size) noexcept { frame_cache::instance().deallocate(p, size); }
+
+	[[nodiscard]] optional_return<T> get_return_object() noexcept { return optional_return<T>{ *this }; }
+	[[nodiscard]] std::suspend_never initial_suspend() const noexcept { return {}; }
+	[[nodiscard]] std::suspend_never final_suspend() const noexcept { return {}; }
+
+	template <typename U = T>
+		requires std::is_assignable_v<optional<T> &, U &&>
+	void return_value(U && value) noexcept(std::is_nothrow_assignable_v<optional<T> &, U &&>) {
+		return_->value_ = static_cast<U &&>(value);
+	}
+	// exceptions propagate to the caller, the frame is destroyed on the way
+	[[noreturn]] void unhandled_exception() const { throw; }
+
+	template <typename O>
+		requires optional_type<O>
+	[[nodiscard]] optional_awaiter<O> await_transform(O && o) const noexcept {
+		return optional_awaiter<O>{ static_cast<O &&>(o) };
+	}
+};
+
+} // non-exported namespace dtl
+} // anonymous namespace
+} // namespace OPTIONAL_NAMESPACE
+
+template <typename T, typename... Args>
+	requires std::is_object_v<T>
+struct std::coroutine_traits<::OPTIONAL_NAMESPACE::optional<T>, Args...> {
+	using promise_type = ::OPTIONAL_NAMESPACE::dtl::optional_promise<T>;
+};
+
+#undef OPTIONAL_NAMESPACE
@@ -0,0 +1,319 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#pragma push_macro("OPTIONAL_NAMESPACE")
+#include "optional.hpp"
+#pragma pop_macro("OPTIONAL_NAMESPACE")
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#ifndef OPTIONAL_NAMESPACE
+#define OPTIONAL_NAMESPACE boost
+#endif
+
+namespace OPTIONAL_NAMESPACE {
+namespace {
+namespace dtl {
+
+// the narrowest unsigned integer with a bit per field
+template <std::size_t N>
+using field_mask_t = std::conditional_t<
+	N <= 8, std::uint8_t,
+	std::conditional_t<N <= 16, std::uint16_t, std::conditional_t<N <= 32, std::uint32_t, std::uint64_t>>>;
+
+template <std::size_t N>
+struct field_layout {
+	std::array<std::size_t, N> offset{};
+	std::size_t size = 0;
+};
+
+// the payloads laid out by decreasing alignment, so that none of them is padded. Fields of equal
+// alignment keep their order.
+template <typename... Ts>
+[[nodiscard]] constexpr field_layout<sizeof...(Ts)> pack_fields() {
+	constexpr std::size_t N = sizeof...(Ts);
+	const std::array<std::size_t, N> sizes{ sizeof(Ts)... };
+	const std::array<std::size_t, N> aligns{ alignof(Ts)... };
+	std::array<std::size_t, N> order{};
+	for (std::size_t i = 0; i < N; ++i) {
+		std::size_t j = i;
+		for (; j > 0 && aligns[order[j - 1]] < aligns[i]; --j)
+			order[j] = order[j - 1];
+		order[j] = i;
+	}
+	field_layout<N> result;
+	for (const std::size_t i : order) {
+		result.size      = (result.size + aligns[i] - 1) / aligns[i] * aligns[i];
+		result.offset[i] = result.size;
+		result.size += sizes[i];
+	}
+	return result;
+}
+
+template <typename... Ts>
+concept trivial_fields = (std::is_trivially_copyable_v<Ts> && ...);
+
+} // non-exported namespace dtl
+} // anonymous namespace
+
+// a tuple of optionals sharing one presence mask: the payloads are packed without padding, the
+// engagement states are the bits of a single integer. Bit I of mask() is set if field I is
+// engaged. Fields are observed as optional<T &>, whole records are tested, merged and updated by
+// their masks. Trivially copyable payloads make an optional_fields trivially copyable.
+template <typename... Ts>
+	requires (sizeof...(Ts) > 0 && sizeof...(Ts) <= 64 &&
+	          ((std::is_object_v<Ts> && !std::is_array_v<Ts> && !std::is_const_v<Ts>) && ...))
+class optional_fields {
+public:
+	using mask_type = dtl::field_mask_t<sizeof...(Ts)>;
+	template <std::size_t I>
+	using field_type = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+	// the mask of fields I...
+	template <std::size_t... I>
+		requires ((I < sizeof...(Ts)) && ...)
+	static constexpr mask_type mask_of = static_cast<mask_type>(((std::uint64_t{ 1 } << I) | ... | 0));
+	static constexpr mask_type full_mask = static_cast<mask_type>(~std::uint64_t{ 0 } >> (64 - sizeof...(Ts)));
+
+private:
+	static constexpr auto layout  = dtl::pack_fields<Ts...>();
+	static constexpr auto indices = std::index_sequence_for<Ts...>{};
+
+	alignas(Ts...) std::byte storage_[layout.size];
+	mask_type mask_ = 0;
+
+	template <std::size_t I>
+	[[nodiscard]] field_type<I> * address() noexcept {
+		return std::launder(reinterpret_cast<field_type<I> *>(storage_ + layout.offset[I]));
+	}
+	template <std::size_t I>
+	[[nodiscard]] const field_type<I> * address() const noexcept {
+		return std::launder(reinterpret_cast<const field_type<I> *>(storage_ + layout.offset[I]));
+	}
+
+	// calls f(std::integral_constant<std::size_t, I>) for all fields I in mask m
+	template <typename F, std::size_t... I>
+	static void for_each(mask_type m, F && f, std::index_sequence<I...>) {
+		((m & mask_of<I> ? f(std::integral_constant<std::size_t, I>{}) : void()), ...);
+	}
+
+	template <std::size_t I, typename... Args>
+	field_type<I> & construct(Args &&... args) {
+		field_type<I> * const p = ::new (static_cast<void *>(storage_ + layout.offset[I]))
+			field_type<I>(static_cast<Args &&>(args)...);
+		mask_ |= mask_of<I>;
+		return *p;
+	}
+
+	// the fields in m from other, disengaged here before
+	template <typename Other>
+	void construct_from(Other && other, mask_type m) {
+		for_each(m, [&](auto i) {
+			if constexpr (std::is_lvalue_reference_v<Other>)
+				construct<i>(*other.template address<i>());
+			else
+				construct<i>(static_cast<field_type<i> &&>(*other.template address<i>()));
+		}, indices);
+	}
+
+	template <typename Other>
+	void assign_from(Other && other, mask_type m) {
+		for_each(m, [&](auto i) {
+			if constexpr (std::is_lvalue_reference_v<Other>)
+				set<i>(*other.template address<i>());
+			else
+				set<i>(static_cast<field_type<i> &&>(*other.template address<i>()));
+		}, indices);
+	}
+
+public:
+	// construction, all fields disengaged
+	[[nodiscard]] constexpr optional_fields() noexcept {}
+
+	// the constructors below delegate to the default one: should a field throw, the destructor
+	// resets the fields made before
+
+	// from one optional per field, e.g. optional_fields<int, double>{ 1, none }
+	[[nodiscard]] optional_fields(const optional<Ts> &... fields) : optional_fields() {
+		[&]<std::size_t... I>(std::index_sequence<I...>) {
+			((fields ? void(construct<I>(*fields)) : void()), ...);
+		}(indices);
+	}
+
+	optional_fields(const optional_fields &) requires dtl::trivial_fields<Ts...> = default;
+	optional_fields(const optional_fields & other) : optional_fields() { construct_from(other, other.mask_); }
+	optional_fields(optional_fields &&) requires dtl::trivial_fields<Ts...> = default;
+	optional_fields(optional_fields && other) noexcept((std::is_nothrow_move_constructible_v<Ts> && ...))
+	: optional_fields() {
+		construct_from(static_cast<optional_fields &&>(other), other.mask_);
+	}
+
+	optional_fields & operator=(const optional_fields &) requires dtl::trivial_fields<Ts...> = default;
+	optional_fields & operator=(const optional_fields & other) {
+		if (this != &other) {
+			reset(static_cast<mask_type>(mask_ & ~other.mask_));
+			assign_from(other, other.mask_);
+		}
+		return *this;
+	}
+	optional_fields & operator=(optional_fields &&) requires dtl::trivial_fields<Ts...> = default;
+	optional_fields & operator=(optional_fields && other) noexcept(
+		((std::is_nothrow_move_constructible_v<Ts> && std::is_nothrow_move_assignable_v<Ts>) && ...)) {
+		if (this != &other) {
+			reset(static_cast<mask_type>(mask_ & ~other.mask_));
+			assign_from(static_cast<optional_fields &&>(other), other.mask_);
+		}
+		return *this;
+	}
+
+	~optional_fields() requires (std::is_trivially_destructible_v<Ts> && ...) = default;
+	~optional_fields() { reset(); }
+
+	[[nodiscard]] static constexpr std::size_t size() noexcept { return sizeof...(Ts); }
+
+	// fields
+	template <std::size_t I>
+	[[nodiscard]] optional<field_type<I> &> get() noexcept {
+		if (mask_ & mask_of<I>)
+			return *address<I>();
+		return none;
+	}
+	template <std::size_t I>
+	[[nodiscard]] optional<const field_type<I> &> get() const noexcept {
+		if (mask_ & mask_of<I>)
+			return *address<I>();
+		return none;
+	}
+
+	template <std::size_t I>
+	[[nodiscard]] bool has_value() const noexcept {
+		return (mask_ & mask_of<I>) != 0;
+	}
+
+	template <std::size_t I, typename... Args>
+		requires std::is_constructible_v<field_type<I>, Args...>
+	field_type<I> & emplace(Args &&... args) {
+		reset(mask_of<I>);
+		return construct<I>(static_cast<Args &&>(args)...);
+	}
+
+	template <std::size_t I, typename U = field_type<I>>
+		requires (std::is_constructible_v<field_type<I>, U> && std::is_assignable_v<field_type<I> &, U>)
+	field_type<I> & set(U && value) {
+		if (mask_ & mask_of<I>)
+			return *address<I>() = static_cast<U &&>(value);
+		return construct<I>(static_cast<U &&>(value));
+	}
+
+	template <std::size_t I>
+	void reset() noexcept {
+		reset(mask_of<I>);
+	}
+
+	// disengages the fields in m, all by default
+	void reset(mask_type m = full_mask) noexcept {
+		if constexpr (!(std::is_trivially_destructible_v<Ts> && ...))
+			for_each(static_cast<mask_type>(mask_ & m), [&](auto i) { std::destroy_at(address<i>()); }, indices);
+		mask_ &= static_cast<mask_type>(~m);
+	}
+
+	// whole records
+	[[nodiscard]] mask_type mask() const noexcept { return mask_; }
+	[[nodiscard]] std::size_t count() const noexcept { return static_cast<std::size_t>(std::popcount(mask_)); }
+	[[nodiscard]] bool empty() const noexcept { return mask_ == 0; }
+
+	// are all, or any, of the fields in m engaged
+	[[nodiscard]] bool all(mask_type m = full_mask) const noexcept { return (mask_ & m) == m; }
+	[[nodiscard]] bool any(mask_type m = full_mask) const noexcept { return (mask_ & m) != 0; }
+
+	// engages the fields disengaged here with the engaged ones of other
+	optional_fields & merge(const optional_fields & other) {
+		construct_from(other, static_cast<mask_type>(other.mask_ & ~mask_));
+		return *this;
+	}
+	optional_fields & merge(optional_fields && other) {
+		construct_from(static_cast<optional_fields &&>(other), static_cast<mask_type>(other.mask_ & ~mask_));
+		return *this;
+	}
+
+	// overwrites the fields here with the engaged ones of other
+	optional_fields & update(const optional_fields & other) {
+		assign_from(other, other.mask_);
+		return *this;
+	}
+	optional_fields & update(optional_fields && other) {
+		assign_from(static_cast<optional_fields &&>(other), other.mask_);
+		return *this;
+	}
+
+	void swap(optional_fields & other) noexcept(
+		((std::is_nothrow_move_constructible_v<Ts> && std::is_nothrow_swappable_v<Ts>) && ...)) {
+		if constexpr (dtl::trivial_fields<Ts...>) {
+			std::swap(*this, other);
+		} else {
+			for_each(static_cast<mask_type>(mask_ | other.mask_), [&](auto i) {
+				const bool mine = has_value<i>(), theirs = other.template has_value<i>();
+				if (mine && theirs) {
+					using std::swap;
+					swap(*address<i>(), *other.template address<i>());
+				} else if (mine) {
+					other.template construct<i>(static_cast<field_type<i> &&>(*address<i>()));
+					reset<i>();
+				} else {
+					construct<i>(static_cast<field_type<i> &&>(*other.template address<i>()));
+					other.template reset<i>();
+				}
+			}, indices);
+		}
+	}
+	friend void swap(optional_fields & lhs, optional_fields & rhs) noexcept(noexcept(lhs.swap(rhs))) {
+		lhs.swap(rhs);
+	}
+
+	// equal if the same fields are engaged with equal payloads
+	[[nodiscard]] friend bool operator==(const optional_fields & lhs, const optional_fields & rhs)
+		requires (dtl::eq_comparable<Ts, Ts> && ...)
+	{
+		if (lhs.mask_ != rhs.mask_)
+			return false;
+		bool equal = true;
+		for_each(lhs.mask_, [&](auto i) {
+			equal = equal && static_cast<bool>(*lhs.template address<i>() == *rhs.template address<i>());
+		}, indices);
+		return equal;
+	}
+}; // class optional_fields
+
+} // namespace OPTIONAL_NAMESPACE
+
+// tuple protocol: structured bindings name the fields as optional<T &>
+namespace std {
+
+template <typename... Ts>
+struct tuple_size<::OPTIONAL_NAMESPACE::optional_fields<Ts...>> : integral_constant<size_t, sizeof...(Ts)> {};
+
+template <size_t I, typename... Ts>
+struct tuple_element<I, ::OPTIONAL_NAMESPACE::optional_fields<Ts...>> {
+	using type = ::OPTIONAL_NAMESPACE::optional<tuple_element_t<I, tuple<Ts...>> &>;
+};
+template <size_t I, typename... Ts>
+struct tuple_element<I, const ::OPTIONAL_NAMESPACE::optional_fields<Ts...>> {
+	using type = ::OPTIONAL_NAMESPACE::optional<const tuple_element_t<I, tuple<Ts...>> &>;
+};
+
+} // namespace std
+
+#undef OPTIONAL_NAMESPACE
@@ -0,0 +1,378 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#pragma push_macro("OPTIONAL_NAMESPACE")
+#include "optional.hpp"
+#pragma pop_macro("OPTIONAL_NAMESPACE")
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <version>
+
+#ifdef __cpp_lib_execution
+#  include <execution>
+#endif
+
+#ifndef OPTIONAL_NAMESPACE
+#define OPTIONAL_NAMESPACE boost
+#endif
+
+namespace OPTIONAL_NAMESPACE {
+
+// a fixed set of worker threads running data parallel loops together with the calling thread.
+// The iteration space is cut into chunks of grain iterations which the threads claim one after
+// another from a shared counter, so faster threads simply take more chunks. One loop runs at a
+// time, further callers wait for it.
+class thread_pool {
+	struct job {
+		void (*run)(void * context, std::size_t begin, std::size_t end);
+		void * context;
+		std::size_t size;
+		std::size_t grain;
+		std::atomic<std::size_t> next{ 0 };
+	};
+
+	std::mutex submit_;
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::condition_variable done_;
+	job * job_                = nullptr;
+	std::uint64_t generation_ = 0;
+	std::size_t busy_         = 0;
+	bool stop_                = false;
+	std::vector<std::thread> workers_;
+
+	static void run_chunks(job & j) {
+		for (;;) {
+			const std::size_t begin = j.next.fetch_add(j.grain, std::memory_order_relaxed);
+			if (begin >= j.size)
+				return;
+			j.run(j.context, begin, std::min(begin + j.grain, j.size));
+		}
+	}
+
+	void work() {
+		std::uint64_t seen = 0;
+		for (;;) {
+			job * j;
+			{
+				std::unique_lock lock(mutex_);
+				wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+				if (stop_)
+					return;
+				seen = generation_;
+				j    = job_;
+			}
+			run_chunks(*j);
+			std::lock_guard lock(mutex_);
+			if (--busy_ == 0)
+				done_.notify_one();
+		}
+	}
+
+public:
+	// threads counts the calling thread, threads - 1 workers are started
+	explicit thread_pool(unsigned threads = std::max(1u, std::thread::hardware_concurrency())) {
+		workers_.reserve(threads > 1 ? threads - 1 : 0);
+		for (unsigned i = 1; i < threads; ++i)
+			workers_.emplace_back([this] { work(); });
+	}
+	thread_pool(const thread_pool &) = delete;
+	thread_pool & operator=(const thread_pool &) = delete;
+	~thread_pool() {
+		{
+			std::lock_guard lock(mutex_);
+			stop_ = true;
+		}
+		wake_.notify_all();
+		for (auto & worker : workers_)
+			worker.join();
+	}
+
+	[[nodiscard]] unsigned size() const noexcept { return static_cast<unsigned>(workers_.size() + 1); }
+
+	// calls f(begin, end) for consecutive chunks of [0, size) with at most grain iterations each,
+	// on all threads of the pool. Returns when all chunks are done and rethrows the first exception
+	// thrown by f, if any.
+	template <typename F>
+	void parallel_for(std::size_t size, std::size_t grain, F && f) {
+		if (size == 0)
+			return;
+		if (workers_.empty() || size <= grain)
+			return static_cast<void>(f(std::size_t{ 0 }, size));
+
+		struct context {
+			F & f;
+			std::mutex mutex;
+			std::exception_ptr error;
+		} ctx{ f, {}, {} };
+		job j{ [](void * c, std::size_t begin, std::size_t end) {
+			      auto & ctx = *static_cast<context *>(c);
+			      try {
+				      ctx.f(begin, end);
+			      } catch (...) {
+				      std::lock_guard lock(ctx.mutex);
+				      if (!ctx.error)
+					      ctx.error = std::current_exception();
+			      }
+		      },
+			   &ctx, size, grain };
+
+		std::lock_guard submit(submit_);
+		{
+			std::lock_guard lock(mutex_);
+			job_  = &j;
+			busy_ = workers_.size();
+			++generation_;
+		}
+		wake_.notify_all();
+		run_chunks(j);
+		{
+			std::unique_lock lock(mutex_);
+			done_.wait(lock, [&] { return busy_ == 0; });
+			job_ = nullptr;
+		}
+		if (ctx.error)
+			std::rethrow_exception(ctx.error);
+	}
+};
+
+namespace {
+namespace dtl {
+
+// random access ranges of optionals, std::optional and boost::optional alike
+template <typename It>
+concept optional_input = std::random_access_iterator<It> && optional_type<std::iter_value_t<It>> &&
+                         !std::is_reference_v<typename std::iter_value_t<It>::value_type>;
+
+template <typename It>
+using input_payload_t = std::remove_cv_t<typename std::iter_value_t<It>::value_type>;
+
+template <typename Exec>
+concept pool_executor = std::same_as<std::remove_cvref_t<Exec>, thread_pool>;
+
+#ifdef __cpp_lib_execution
+template <typename Exec>
+concept executor = pool_executor<Exec> || std::is_execution_policy_v<std::remove_cvref_t<Exec>>;
+#else
+template <typename Exec>
+concept executor = pool_executor<Exec>;
+#endif
+
+// iterations per chunk: large enough to amortize claiming it, small enough to balance the load
+inline constexpr std::size_t parallel_grain = std::size_t{ 1 } << 16;
+
+// the payload, or T{} if disengaged, without branching for arithmetic payloads
+template <typename O>
+[[nodiscard]] constexpr auto payload_or_default(const O & o) {
+	if constexpr (branchless_optional<O>)
+		return payload_or_zero(o);
+	else
+		return o.has_value() ? *o : typename O::value_type{};
+}
+
+// reduces transform(*it) over [first, last) by combine, which must be associative and commutative
+template <typename Exec, typename It, typename Acc, typename Combine, typename Transform>
+[[nodiscard]] Acc parallel_reduce(Exec && exec, It first, It last, Acc identity, Combine combine,
+                                  Transform transform) {
+	if constexpr (pool_executor<Exec>) {
+		const auto size = static_cast<std::size_t>(last - first);
+		std::vector<Acc> partials((size + parallel_grain - 1) / parallel_grain, identity);
+		exec.parallel_for(size, parallel_grain, [&](std::size_t begin, std::size_t end) {
+			partials[begin / parallel_grain] =
+				std::transform_reduce(first + static_cast<std::ptrdiff_t>(begin), first + static_cast<std::ptrdiff_t>(end),
+			                          identity, combine, transform);
+		});
+		return std::reduce(partials.begin(), partials.end(), identity, combine);
+	} else {
+		return std::transform_reduce(exec, first, last, identity, combine, transform);
+	}
+}
+
+// the least or greatest payload so far, any tells whether there was one. Disengaged elements
+// contribute the identity of the fold, so arithmetic payloads are folded without branches.
+template <typename T>
+struct extremum {
+	T value;
+	bool any;
+};
+
+// the least payload if Least, the greatest otherwise
+template <bool Least, typename Exec, typename It>
+[[nodiscard]] optional<input_payload_t<It>> parallel_extremum(Exec && exec, It first, It last) {
+	using T               = input_payload_t<It>;
+	constexpr auto select = [](const T & lhs, const T & rhs) -> const T & {
+		if constexpr (Least)
+			return rhs < lhs ? rhs : lhs;
+		else
+			return lhs < rhs ? rhs : lhs;
+	};
+	if constexpr (std::is_arithmetic_v<T>) {
+		using limits      = std::numeric_limits<T>;
+		constexpr T worst = limits::has_infinity ? (Least ? limits::infinity() : -limits::infinity())
+		                                         : (Least ? limits::max() : limits::lowest());
+		const auto result = parallel_reduce(
+			exec, first, last, extremum<T>{ worst, false },
+			[select](const extremum<T> & lhs, const extremum<T> & rhs) {
+				return extremum<T>{ select(lhs.value, rhs.value), static_cast<bool>(lhs.any | rhs.any) };
+			},
+			[](const auto & o) {
+				const T value = payload_or_zero(o);
+				return extremum<T>{ o.has_value() ? value : worst, o.has_value() };
+			});
+		if (result.any)
+			return result.value;
+		return none;
+	} else {
+		// other payloads are referred to, not copied
+		const T * result = parallel_reduce(
+			exec, first, last, static_cast<const T *>(nullptr),
+			[select](const T * lhs, const T * rhs) {
+				if (!lhs || !rhs)
+					return lhs ? lhs : rhs;
+				return &select(*lhs, *rhs) == lhs ? lhs : rhs;
+			},
+			[](const auto & o) { return o.has_value() ? std::addressof(*o) : static_cast<const T *>(nullptr); });
+		if (result)
+			return *result;
+		return none;
+	}
+}
+
+template <typename T>
+concept summable = std::default_initializable<T> && requires(const T & a, const T & b) {
+	{ a + b } -> std::convertible_to<T>;
+};
+
+struct sum_and_count {
+	double sum;
+	std::size_t count;
+
+	[[nodiscard]] friend constexpr sum_and_count operator+(const sum_and_count & lhs, const sum_and_count & rhs) noexcept {
+		return { lhs.sum + rhs.sum, lhs.count + rhs.count };
+	}
+};
+
+} // non-exported namespace dtl
+} // anonymous namespace
+
+// null-aware algorithms on random access ranges of optionals: disengaged elements are skipped.
+// exec is a thread_pool or, where the standard library provides them, an execution policy like
+// std::execution::par, and the work is spread accordingly.
+
+// the number of engaged elements
+template <typename Exec, typename It>
+	requires dtl::executor<Exec> && dtl::optional_input<It>
+[[nodiscard]] std::size_t count_engaged(Exec && exec, It first, It last) {
+	return dtl::parallel_reduce(exec, first, last, std::size_t{ 0 }, std::plus<>{},
+	                            [](const auto & o) -> std::size_t { return o.has_value(); });
+}
+
+// the sum of the engaged payloads, T{} if there are none
+template <typename Exec, typename It>
+	requires dtl::executor<Exec> && dtl::optional_input<It> && dtl::summable<dtl::input_payload_t<It>>
+[[nodiscard]] dtl::input_payload_t<It> sum_engaged(Exec && exec, It first, It last) {
+	using T = dtl::input_payload_t<It>;
+	return dtl::parallel_reduce(exec, first, last, T{}, [](const T & lhs, const T & rhs) -> T { return lhs + rhs; },
+	                            [](const auto & o) -> T { return dtl::payload_or_default(o); });
+}
+
+// the arithmetic mean of the engaged payloads, none if there are none
+template <typename Exec, typename It>
+	requires dtl::executor<Exec> && dtl::optional_input<It> && std::is_arithmetic_v<dtl::input_payload_t<It>>
+[[nodiscard]] optional<double> mean_engaged(Exec && exec, It first, It last) {
+	const auto total = dtl::parallel_reduce(exec, first, last, dtl::sum_and_count{ 0.0, 0 }, std::plus<>{},
+	                                        [](const auto & o) {
+		                                        return dtl::sum_and_count{ static_cast<double>(dtl::payload_or_zero(o)),
+		                                                                   o.has_value() };
+	                                        });
+	if (total.count != 0)
+		return total.sum / static_cast<double>(total.count);
+	return none;
+}
+
+// the least engaged payload by operator<, none if there are none
+template <typename Exec, typename It>
+	requires dtl::executor<Exec> && dtl::optional_input<It> && std::totally_ordered<dtl::input_payload_t<It>>
+[[nodiscard]] optional<dtl::input_payload_t<It>> min_engaged(Exec && exec, It first, It last) {
+	return dtl::parallel_extremum<true>(exec, first, last);
+}
+
+// the greatest engaged payload by operator<, none if there are none
+template <typename Exec, typename It>
+	requires dtl::executor<Exec> && dtl::optional_input<It> && std::totally_ordered<dtl::input_payload_t<It>>
+[[nodiscard]] optional<dtl::input_payload_t<It>> max_engaged(Exec && exec, It first, It last) {
+	return dtl::parallel_extremum<false>(exec, first, last);
+}
+
+// the first engaged element, or last
+template <typename Exec, typename It>
+	requires dtl::executor<Exec> && dtl::optional_input<It>
+[[nodiscard]] It first_engaged(Exec && exec, It first, It last) {
+	if constexpr (dtl::pool_executor<Exec>) {
+		const auto size = static_cast<std::size_t>(last - first);
+		std::atomic<std::size_t> found{ size };
+		exec.parallel_for(size, dtl::parallel_grain, [&](std::size_t begin, std::size_t end) {
+			// chunks are claimed in ascending order, those behind a hit have nothing to contribute
+			if (begin >= found.load(std::memory_order_relaxed))
+				return;
+			for (std::size_t i = begin; i < end; ++i) {
+				if (first[static_cast<std::ptrdiff_t>(i)].has_value()) {
+					std::size_t current = found.load(std::memory_order_relaxed);
+					while (i < current && !found.compare_exchange_weak(current, i, std::memory_order_relaxed))
+						;
+					return;
+				}
+			}
+		});
+		return first + static_cast<std::ptrdiff_t>(found.load(std::memory_order_relaxed));
+	} else {
+		return std::find_if(exec, first, last, [](const auto & o) { return o.has_value(); });
+	}
+}
+
+// writes the optional of f(*o) for every element o, none for the disengaged ones, like o.map(f).
+// Returns the end of the output.
+template <typename Exec, typename It, typename Out, typename F>
+	requires dtl::executor<Exec> && dtl::optional_input<It> && std::random_access_iterator<Out> &&
+	         dtl::optional_type<std::iter_value_t<Out>> &&
+	         std::is_assignable_v<std::iter_reference_t<Out>, std::invoke_result_t<F &, const dtl::input_payload_t<It> &>>
+Out transform_engaged(Exec && exec, It first, It last, Out out, F f) {
+	const auto map = [&f](const auto & o) -> std::iter_value_t<Out> {
+		if (o.has_value())
+			return std::invoke(f, *o);
+		return none;
+	};
+	if constexpr (dtl::pool_executor<Exec>) {
+		const auto size = static_cast<std::size_t>(last - first);
+		exec.parallel_for(size, dtl::parallel_grain, [&](std::size_t begin, std::size_t end) {
+			std::transform(first + static_cast<std::ptrdiff_t>(begin), first + static_cast<std::ptrdiff_t>(end),
+			               out + static_cast<std::ptrdiff_t>(begin), map);
+		});
+		return out + static_cast<std::ptrdiff_t>(size);
+	} else {
+		return std::transform(exec, first, last, out, map);
+	}
+}
+
+} // namespace OPTIONAL_NAMESPACE
+
+#undef OPTIONAL_NAMESPACE
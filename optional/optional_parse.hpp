@@ -0,0 +1,317 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#pragma push_macro("OPTIONAL_NAMESPACE")
+#include "optional_vector.hpp"
+#pragma pop_macro("OPTIONAL_NAMESPACE")
+
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if !defined(OPTIONAL_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || _M_IX86_FP >= 2)
+#  define OPTIONAL_SIMD_SSE2
+#  include <emmintrin.h>
+#endif
+
+#ifndef OPTIONAL_NAMESPACE
+#define OPTIONAL_NAMESPACE boost
+#endif
+
+namespace OPTIONAL_NAMESPACE {
+
+inline constexpr std::string_view default_null_tokens[] = { "NULL", "\\N" };
+
+// delimited text: fields are separated by the delimiter and records by line breaks, a carriage
+// return before a line break is dropped. Empty fields and fields spelled like one of the null
+// tokens are disengaged, all others must be numbers in the format of std::from_chars.
+struct field_format {
+	char delimiter                                = ',';
+	std::span<const std::string_view> null_tokens = default_null_tokens;
+	bool invalid_as_none                          = false; // rather than throwing std::invalid_argument
+};
+
+namespace {
+namespace dtl {
+
+template <typename T>
+concept parsable = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+// calls f(field, end_of_record) for every field in text until f returns false. Delimiters and
+// line breaks are located 16 characters at a time.
+template <typename F>
+constexpr void for_each_field(std::string_view text, char delimiter, F && f) {
+	const char * const first = text.data();
+	const char * const last  = first + text.size();
+	const char * field       = first;
+	const char * p           = first;
+
+	const auto emit = [&](const char * stop) {
+		const char * end = stop;
+		if (end != field && end[-1] == '\r' && *stop == '\n')
+			--end;
+		const bool more = f(std::string_view(field, static_cast<std::size_t>(end - field)), *stop == '\n');
+		field           = stop + 1;
+		return more;
+	};
+
+#if defined(OPTIONAL_SIMD_SSE2)
+	if (!std::is_constant_evaluated()) {
+		const __m128i delimiters = _mm_set1_epi8(delimiter);
+		const __m128i newlines   = _mm_set1_epi8('\n');
+		for (; last - p >= 16; p += 16) {
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+			auto stops          = static_cast<unsigned>(_mm_movemask_epi8(
+				_mm_or_si128(_mm_cmpeq_epi8(chunk, delimiters), _mm_cmpeq_epi8(chunk, newlines))));
+			for (; stops != 0; stops &= stops - 1)
+				if (!emit(p + std::countr_zero(stops)))
+					return;
+		}
+	}
+#endif
+	for (; p != last; ++p)
+		if ((*p == delimiter || *p == '\n') && !emit(p))
+			return;
+
+	// an unterminated last record
+	if (field != last || (first != last && last[-1] == delimiter))
+		f(std::string_view(field, static_cast<std::size_t>(last - field)), true);
+}
+
+// 8 decimal digits, none if any isn't a digit
+[[nodiscard]] inline bool parse_8_digits(const char * first, std::uint64_t & value) noexcept {
+	std::uint64_t word;
+	std::memcpy(&word, first, sizeof(word));
+	if constexpr (std::endian::native == std::endian::big) { // the first digit into the lowest byte
+		std::uint64_t swapped = 0;
+		for (int i = 0; i < 8; ++i)
+			swapped |= ((word >> 8 * i) & 0xFF) << (56 - 8 * i);
+		word = swapped;
+	}
+	if ((word & 0xF0F0F0F0F0F0F0F0) != 0x3030303030303030 ||
+	    ((word + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) != 0x3030303030303030)
+		return false;
+	word  = (word & 0x0F0F0F0F0F0F0F0F) * 2561 >> 8;
+	word  = (word & 0x00FF00FF00FF00FF) * 6553601 >> 16;
+	value = (word & 0x0000FFFF0000FFFF) * 42949672960001 >> 32;
+	return true;
+}
+
+// 1 to 19 digits, the leading n % 8 one by one, then 8 at a time
+[[nodiscard]] inline bool parse_unsigned(const char * first, const char * last, std::uint64_t & value) noexcept {
+	const auto n = static_cast<std::size_t>(last - first);
+	if (n == 0 || n > 19)
+		return false;
+	value = 0;
+	for (const char * head = first + n % 8; first != head; ++first) {
+		if (*first < '0' || *first > '9')
+			return false;
+		value = value * 10 + static_cast<std::uint64_t>(*first - '0');
+	}
+	for (; first != last; first += 8) {
+		std::uint64_t digits;
+		if (!parse_8_digits(first, digits))
+			return false;
+		value = value * 100000000 + digits;
+	}
+	return true;
+}
+
+inline constexpr double exact_powers_of_ten[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+	                                              1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+	                                              1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+// the common cases without std::from_chars: integers of up to 19 digits, and floating-point
+// numbers without exponent whose digits fit into the significand. Those are exact, or correctly
+// rounded by a single division by an exact power of ten. Everything else is up to std::from_chars.
+template <typename T>
+[[nodiscard]] bool parse_number(std::string_view field, T & value) noexcept {
+	const char * const last = field.data() + field.size();
+	const bool negative     = !field.empty() && field.front() == '-';
+	const char * first      = field.data() + negative;
+	std::uint64_t magnitude;
+	if constexpr (std::is_integral_v<T>) {
+		if ((std::is_signed_v<T> || !negative) && parse_unsigned(first, last, magnitude) &&
+		    magnitude <= static_cast<std::uint64_t>(std::numeric_limits<T>::max()) + negative) {
+			using U = std::make_unsigned_t<T>;
+			value   = static_cast<T>(negative ? U(0) - static_cast<U>(magnitude) : static_cast<U>(magnitude));
+			return true;
+		}
+	} else if constexpr (std::numeric_limits<T>::is_iec559 && sizeof(T) <= sizeof(double)) {
+		constexpr std::uint64_t exact   = std::uint64_t{ 1 } << std::numeric_limits<T>::digits;
+		constexpr std::size_t max_scale = std::numeric_limits<T>::digits > 24 ? 22 : 10;
+		const char * point = static_cast<const char *>(std::memchr(first, '.', static_cast<std::size_t>(last - first)));
+		const std::size_t scale = point ? static_cast<std::size_t>(last - point - 1) : 0;
+		std::uint64_t fraction  = 0;
+		if (scale <= max_scale && parse_unsigned(first, point ? point : last, magnitude) &&
+		    (scale == 0 || (static_cast<std::size_t>(point - first) + scale <= 19 &&
+		                    parse_unsigned(point + 1, last, fraction)))) {
+			const double power = exact_powers_of_ten[scale];
+			magnitude          = magnitude * static_cast<std::uint64_t>(power) + fraction;
+			if (magnitude < exact) {
+				const T result = static_cast<T>(magnitude) / static_cast<T>(power);
+				value          = negative ? -result : result;
+				return true;
+			}
+		}
+	}
+	const auto [ptr, ec] = std::from_chars(field.data(), last, value);
+	return ec == std::errc{} && ptr == last;
+}
+
+// null token lookup, most fields are rejected by their length alone
+class null_matcher {
+	std::span<const std::string_view> tokens_;
+	std::uint64_t lengths_ = 1; // the empty field
+
+public:
+	constexpr explicit null_matcher(std::span<const std::string_view> tokens) noexcept
+	: tokens_(tokens) {
+		for (const auto token : tokens)
+			lengths_ |= token.size() < 64 ? std::uint64_t{ 1 } << token.size() : 0;
+	}
+
+	[[nodiscard]] constexpr bool operator()(std::string_view field) const noexcept {
+		if (field.size() >= 64 ? false : !(lengths_ & (std::uint64_t{ 1 } << field.size())))
+			return false;
+		if (field.empty())
+			return true;
+		for (const auto token : tokens_)
+			if (token == field)
+				return true;
+		return false;
+	}
+};
+
+template <parsable T>
+class field_parser {
+	null_matcher is_null_;
+	bool invalid_as_none_;
+
+public:
+	constexpr explicit field_parser(const field_format & format) noexcept
+	: is_null_(format.null_tokens)
+	, invalid_as_none_(format.invalid_as_none) {}
+
+	// returns whether the field is engaged and its value in value
+	[[nodiscard]] bool operator()(std::string_view field, T & value) const {
+		if (is_null_(field))
+			return false;
+		if (parse_number(field, value)) [[likely]]
+			return true;
+		if (invalid_as_none_)
+			return false;
+		throw std::invalid_argument("optional_parse: invalid field");
+	}
+};
+
+template <parsable T>
+void parse_into(const field_parser<T> & parse, optional_vector<T> & out, std::string_view field) {
+	T value;
+	if (parse(field, value))
+		out.push_back(value);
+	else
+		out.push_back(none);
+}
+
+} // non-exported namespace dtl
+} // anonymous namespace
+
+// the number of fields in text
+[[nodiscard]] constexpr std::size_t count_fields(std::string_view text, char delimiter = ',') {
+	std::size_t count = 0;
+	dtl::for_each_field(text, delimiter, [&](std::string_view, bool) {
+		++count;
+		return true;
+	});
+	return count;
+}
+
+// parses a single field
+template <dtl::parsable T>
+[[nodiscard]] optional<T> parse_field(std::string_view field, const field_format & format = {}) {
+	T value;
+	if (dtl::field_parser<T>(format)(field, value))
+		return value;
+	return none;
+}
+
+// parses the fields of text into out, regardless of records, until out is full. Returns the
+// number of fields parsed.
+template <dtl::parsable T>
+std::size_t parse_fields(std::string_view text, std::span<optional<T>> out, const field_format & format = {}) {
+	const dtl::field_parser<T> parse(format);
+	std::size_t count = 0;
+	if (!out.empty())
+		dtl::for_each_field(text, format.delimiter, [&](std::string_view field, bool) {
+			T value;
+			if (parse(field, value))
+				out[count].emplace(value);
+			else
+				out[count].reset();
+			return ++count != out.size();
+		});
+	return count;
+}
+
+// appends the fields of text to out, regardless of records
+template <dtl::parsable T>
+void parse_fields(std::string_view text, optional_vector<T> & out, const field_format & format = {}) {
+	const dtl::field_parser<T> parse(format);
+	dtl::for_each_field(text, format.delimiter, [&](std::string_view field, bool) {
+		dtl::parse_into(parse, out, field);
+		return true;
+	});
+}
+
+// appends the records of text to the columns, field i of each record to column i. Missing
+// trailing fields are disengaged, surplus fields throw std::invalid_argument. Returns the number
+// of records parsed.
+template <dtl::parsable... Ts>
+	requires(sizeof...(Ts) > 0)
+std::size_t parse_records(std::string_view text, const field_format & format, optional_vector<Ts> &... columns) {
+	const std::tuple<dtl::field_parser<Ts>...> parsers{ dtl::field_parser<Ts>(format)... };
+	std::size_t records = 0;
+	std::size_t column  = 0;
+
+	const auto parse_into = [&]<std::size_t... I>(std::index_sequence<I...>, std::string_view field) {
+		static_cast<void>(((I == column && (dtl::parse_into(std::get<I>(parsers), columns, field), true)) || ...));
+	};
+	const auto pad = [&]<std::size_t... I>(std::index_sequence<I...>) {
+		static_cast<void>(((I >= column ? (columns.push_back(none), 0) : 0), ...));
+	};
+
+	dtl::for_each_field(text, format.delimiter, [&](std::string_view field, bool end_of_record) {
+		if (column == sizeof...(Ts))
+			throw std::invalid_argument("optional_parse: too many fields");
+		parse_into(std::index_sequence_for<Ts...>{}, field);
+		++column;
+		if (end_of_record) {
+			pad(std::index_sequence_for<Ts...>{});
+			column = 0;
+			++records;
+		}
+		return true;
+	});
+	return records;
+}
+
+} // namespace OPTIONAL_NAMESPACE
+
+#undef OPTIONAL_SIMD_SSE2
+#undef OPTIONAL_NAMESPACE
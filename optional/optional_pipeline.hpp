@@ -0,0 +1,231 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#pragma push_macro("OPTIONAL_NAMESPACE")
+#include "optional.hpp"
+#pragma pop_macro("OPTIONAL_NAMESPACE")
+
+#include <tuple>
+#include <utility>
+#include <functional>
+#include <type_traits>
+#include <cstddef>
+
+#ifndef OPTIONAL_NAMESPACE
+#define OPTIONAL_NAMESPACE boost
+#endif
+
+// lazy pipelines over optionals:
+//
+//   opt | then(f) | and_then(g) | then(h) | value_or(x)
+//
+// is equivalent to opt.map(f).flat_map(g).map(h).value_or(x), but the stages are collected
+// into one pipeline object and evaluated in one go: the engagement of opt is tested once,
+// then the callables are invoked back to back with the intermediate results passed on as
+// temporaries. Only and_then stages test again, on the optional returned by their callable.
+// No intermediate optional is materialized, and the final optional is constructed once when
+// a pipeline converts to optional<E>. As optional<T &> binds to any lvalue, a pipeline
+// yielding a reference must be collected with eval().
+
+namespace OPTIONAL_NAMESPACE {
+
+template <typename Func>
+struct then_stage {
+	Func f;
+};
+
+template <typename Func>
+struct and_then_stage {
+	Func f;
+};
+
+template <typename Value>
+struct value_or_stage {
+	Value v;
+};
+
+template <typename Func>
+struct value_or_eval_stage {
+	Func f;
+};
+
+namespace {
+namespace dtl {
+
+template <typename S>
+inline constexpr bool is_then_stage = false;
+template <typename Func>
+inline constexpr bool is_then_stage<then_stage<Func>> = true;
+
+template <typename S>
+inline constexpr bool is_and_then_stage = false;
+template <typename Func>
+inline constexpr bool is_and_then_stage<and_then_stage<Func>> = true;
+
+template <typename S>
+concept stage = is_then_stage<std::remove_cvref_t<S>> || is_and_then_stage<std::remove_cvref_t<S>>;
+
+// the argument type A handed to the next stage and the element type E of the equivalent
+// optional after applying the stages to an argument of type A
+template <typename A, typename E, typename... Stages>
+struct pipeline_types {
+	using argument = A;
+	using element  = E;
+};
+
+template <typename A, typename E, typename Func, typename... Stages>
+struct pipeline_types<A, E, then_stage<Func>, Stages...>
+: pipeline_types<std::invoke_result_t<const Func &, A>, std::invoke_result_t<const Func &, A>, Stages...> {};
+
+template <typename A, typename E, typename Func, typename... Stages>
+struct pipeline_types<A, E, and_then_stage<Func>, Stages...>
+: pipeline_types<decltype(*std::declval<std::invoke_result_t<const Func &, A>>()),
+                 dtl::unwrap_t<std::invoke_result_t<const Func &, A>>, Stages...> {};
+
+// apply the stages I... to v, then pass the result to on_value, or call on_none if an and_then
+// stage yields a disengaged optional. Both continuations return the same type.
+template <std::size_t I, typename Stages, typename V, typename OnValue, typename OnNone>
+constexpr decltype(auto) run_stages(const Stages & stages, V && v, OnValue & on_value, OnNone & on_none) {
+	if constexpr (I == std::tuple_size_v<Stages>) {
+		return on_value(static_cast<V &&>(v));
+	} else {
+		const auto & stage = std::get<I>(stages);
+		if constexpr (is_then_stage<std::tuple_element_t<I, Stages>>) {
+			return run_stages<I + 1>(stages, std::invoke(stage.f, static_cast<V &&>(v)), on_value, on_none);
+		} else {
+			auto && o = std::invoke(stage.f, static_cast<V &&>(v));
+			if (!o)
+				return on_none();
+			return run_stages<I + 1>(stages, *static_cast<decltype(o) &&>(o), on_value, on_none);
+		}
+	}
+}
+
+} // non-exported namespace dtl
+} // anonymous namespace
+
+// Source is either an lvalue reference to the optional at the head of the pipeline, or the
+// optional itself if the pipeline was started from an rvalue
+template <typename Source, typename... Stages>
+class optional_pipeline {
+	using source_type = std::remove_reference_t<Source>;
+	using types       = dtl::pipeline_types<decltype(*std::declval<Source>()),
+                                            typename source_type::value_type, Stages...>;
+
+	Source src_;
+	std::tuple<Stages...> stages_;
+
+	template <typename P, typename OnValue, typename OnNone>
+	static constexpr decltype(auto) evaluate(P && self, OnValue on_value, OnNone on_none) {
+		if (!self.src_)
+			return on_none();
+		if constexpr (std::is_reference_v<Source> || std::is_lvalue_reference_v<P>)
+			return dtl::run_stages<0>(self.stages_, *self.src_, on_value, on_none);
+		else
+			return dtl::run_stages<0>(self.stages_, *static_cast<Source &&>(self.src_), on_value, on_none);
+	}
+
+	template <typename P, typename Stage>
+	static constexpr auto append(P && self, Stage && stage) {
+		return optional_pipeline<Source, Stages..., std::remove_cvref_t<Stage>>{
+			static_cast<P &&>(self).src_,
+			std::tuple_cat(static_cast<P &&>(self).stages_, std::tuple{ static_cast<Stage &&>(stage) })
+		};
+	}
+
+public:
+	// type of the payload after all stages, a reference type if the last stage returns one
+	using element_type = typename types::element;
+	using value_type   = std::remove_cvref_t<element_type>;
+
+	template <typename S, typename T>
+	constexpr optional_pipeline(S && src, T && stages)
+	: src_(static_cast<S &&>(src))
+	, stages_(static_cast<T &&>(stages)) {}
+
+	template <typename Stage>
+		requires dtl::stage<Stage>
+	[[nodiscard]] friend constexpr auto operator|(const optional_pipeline & lhs, Stage && stage) {
+		return append(lhs, static_cast<Stage &&>(stage));
+	}
+	template <typename Stage>
+		requires dtl::stage<Stage>
+	[[nodiscard]] friend constexpr auto operator|(optional_pipeline && lhs, Stage && stage) {
+		return append(std::move(lhs), static_cast<Stage &&>(stage));
+	}
+
+	template <typename Value>
+	[[nodiscard]] friend constexpr value_type operator|(const optional_pipeline & lhs, value_or_stage<Value> stage) {
+		return evaluate(lhs, [](auto && r) -> value_type { return static_cast<decltype(r) &&>(r); },
+		                [&]() -> value_type { return static_cast<Value &&>(stage.v); });
+	}
+	template <typename Value>
+	[[nodiscard]] friend constexpr value_type operator|(optional_pipeline && lhs, value_or_stage<Value> stage) {
+		return evaluate(std::move(lhs), [](auto && r) -> value_type { return static_cast<decltype(r) &&>(r); },
+		                [&]() -> value_type { return static_cast<Value &&>(stage.v); });
+	}
+
+	template <typename Func>
+	[[nodiscard]] friend constexpr value_type operator|(const optional_pipeline & lhs, value_or_eval_stage<Func> stage) {
+		return evaluate(lhs, [](auto && r) -> value_type { return static_cast<decltype(r) &&>(r); },
+		                [&]() -> value_type { return std::invoke(stage.f); });
+	}
+	template <typename Func>
+	[[nodiscard]] friend constexpr value_type operator|(optional_pipeline && lhs, value_or_eval_stage<Func> stage) {
+		return evaluate(std::move(lhs), [](auto && r) -> value_type { return static_cast<decltype(r) &&>(r); },
+		                [&]() -> value_type { return std::invoke(stage.f); });
+	}
+
+	[[nodiscard]] constexpr optional<element_type> eval() const & {
+		return evaluate(*this, [](auto && r) { return optional<element_type>(static_cast<decltype(r) &&>(r)); },
+		                [] { return optional<element_type>{}; });
+	}
+	[[nodiscard]] constexpr optional<element_type> eval() && {
+		return evaluate(std::move(*this),
+		                [](auto && r) { return optional<element_type>(static_cast<decltype(r) &&>(r)); },
+		                [] { return optional<element_type>{}; });
+	}
+
+	constexpr operator optional<element_type>() const & { return eval(); }
+	constexpr operator optional<element_type>() && { return std::move(*this).eval(); }
+}; // class optional_pipeline
+
+// stage factories
+template <typename Func>
+[[nodiscard]] constexpr then_stage<std::decay_t<Func>> then(Func && f) {
+	return { static_cast<Func &&>(f) };
+}
+
+template <typename Func>
+[[nodiscard]] constexpr and_then_stage<std::decay_t<Func>> and_then(Func && f) {
+	return { static_cast<Func &&>(f) };
+}
+
+template <typename Value>
+[[nodiscard]] constexpr value_or_stage<Value &&> value_or(Value && v) {
+	return { static_cast<Value &&>(v) };
+}
+
+template <typename Func>
+[[nodiscard]] constexpr value_or_eval_stage<std::decay_t<Func>> value_or_eval(Func && f) {
+	return { static_cast<Func &&>(f) };
+}
+
+// head of a pipeline: an lvalue optional is referenced, an rvalue one is moved into the pipeline
+template <typename O, typename Stage>
+	requires (dtl::optional_type<O> && dtl::stage<Stage>)
+[[nodiscard]] constexpr auto operator|(O && o, Stage && stage) {
+	using source = std::conditional_t<std::is_lvalue_reference_v<O>, O, std::remove_cvref_t<O>>;
+	return optional_pipeline<source, std::remove_cvref_t<Stage>>{
+		static_cast<O &&>(o), std::tuple{ static_cast<Stage &&>(stage) }
+	};
+}
+
+} // namespace OPTIONAL_NAMESPACE
+
+#undef OPTIONAL_NAMESPACE
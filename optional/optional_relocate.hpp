@@ -0,0 +1,88 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#pragma push_macro("OPTIONAL_NAMESPACE")
+#include "optional.hpp"
+#pragma pop_macro("OPTIONAL_NAMESPACE")
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+#ifndef OPTIONAL_NAMESPACE
+#define OPTIONAL_NAMESPACE boost
+#endif
+
+namespace OPTIONAL_NAMESPACE {
+
+// customization point: a type is trivially relocatable if moving an object to a new address and
+// destroying the source is equivalent to copying its bytes and forgetting the source. That holds
+// for trivially copyable types and is opted into by specializing this trait, e.g. for types which
+// own their resources through pointers but never point into themselves.
+template <typename T>
+struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<std::remove_cv_t<T>>::value;
+
+// an optional<T> is a T plus an engaged flag, or just T in its niche
+template <typename T>
+struct is_trivially_relocatable<optional<T>> : is_trivially_relocatable<T> {};
+
+// an optional<T &> is a pointer
+template <typename T>
+struct is_trivially_relocatable<optional<T &>> : std::true_type {};
+
+// unique_ptr with the default deleter is a pointer as well on all major standard libraries
+template <typename T>
+struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type {};
+
+// relocates the object at source into the uninitialized storage at dest. Afterwards, source
+// is uninitialized storage.
+template <typename T>
+T * relocate_at(T * source, T * dest) noexcept(is_trivially_relocatable_v<T> ||
+                                               std::is_nothrow_move_constructible_v<T>) {
+	if constexpr (is_trivially_relocatable_v<T>) {
+		std::memmove(static_cast<void *>(dest), static_cast<const void *>(source), sizeof(T));
+		return std::launder(dest);
+	} else {
+		T * result = std::construct_at(dest, static_cast<T &&>(*source));
+		std::destroy_at(source);
+		return result;
+	}
+}
+
+// relocates [first, last) into the uninitialized storage starting at dest, returns the end of
+// the relocated range. The ranges may overlap if dest precedes first, as when closing a gap. A
+// bulk memmove for trivially relocatable types, element-wise move and destroy otherwise.
+template <typename T>
+T * uninitialized_relocate(T * first, T * last, T * dest) noexcept(is_trivially_relocatable_v<T> ||
+                                                                   std::is_nothrow_move_constructible_v<T>) {
+	const auto n = static_cast<std::size_t>(last - first);
+	if constexpr (is_trivially_relocatable_v<T>) {
+		if (n != 0)
+			std::memmove(static_cast<void *>(dest), static_cast<const void *>(first), n * sizeof(T));
+		return dest + n;
+	} else {
+		for (; first != last; ++first, ++dest)
+			relocate_at(first, dest);
+		return dest;
+	}
+}
+
+template <typename T>
+T * uninitialized_relocate_n(T * first, std::size_t n, T * dest) noexcept(noexcept(
+	uninitialized_relocate(first, first + n, dest))) {
+	return uninitialized_relocate(first, first + n, dest);
+}
+
+} // namespace OPTIONAL_NAMESPACE
+
+#undef OPTIONAL_NAMESPACE
@@ -0,0 +1,365 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#pragma push_macro("OPTIONAL_NAMESPACE")
+#include "optional_vector.hpp"
+#pragma pop_macro("OPTIONAL_NAMESPACE")
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#ifndef OPTIONAL_NAMESPACE
+#define OPTIONAL_NAMESPACE boost
+#endif
+
+// binary column format for optionals of trivially copyable T, in native byte order:
+//
+//   header   64 bytes   magic "BOOSTOPT", byte order mark, version, layout, sizeof(T), alignof(T),
+//                       elements per block (a power of two, at least 64)
+//   blocks              per block: the presence bitmap of block_elements bits in 64 bit words
+//                       (bit i % 64 of word i / 64, like optional_vector), for the sparse layout
+//                       the number of engaged elements preceding each word as 32 bit integers,
+//                       then the values, aligned to alignof(T). The dense layout stores a value
+//                       for every element with disengaged ones zeroed, the sparse layout stores
+//                       the engaged values only.
+//   index               the file offset of every block, 64 bit each
+//   trailer  32 bytes   number of elements, offset of the index, number of engaged elements,
+//                       magic "BOOSTOPT"
+//
+// The trailer at the end makes the format streamable, the index gives constant-time access to
+// any element. All offsets and values are suitably aligned for a memory-mapped file to be read
+// in place through optional_column_view.
+
+namespace OPTIONAL_NAMESPACE {
+
+enum class column_layout : std::uint32_t { dense, sparse };
+
+namespace {
+namespace dtl {
+
+inline constexpr std::array<char, 8> column_magic{ 'B', 'O', 'O', 'S', 'T', 'O', 'P', 'T' };
+inline constexpr std::uint32_t column_byte_order = 0x01020304;
+inline constexpr std::uint32_t column_version    = 1;
+
+struct column_header {
+	std::array<char, 8> magic;
+	std::uint32_t byte_order;
+	std::uint32_t version;
+	column_layout layout;
+	std::uint32_t value_size;
+	std::uint32_t value_align;
+	std::uint32_t block_elements;
+	std::array<std::uint32_t, 8> reserved;
+};
+static_assert(sizeof(column_header) == 64);
+
+struct column_trailer {
+	std::uint64_t elements;
+	std::uint64_t index_offset;
+	std::uint64_t engaged;
+	std::array<char, 8> magic;
+};
+static_assert(sizeof(column_trailer) == 32);
+
+[[nodiscard]] constexpr std::size_t align_up(std::size_t n, std::size_t alignment) noexcept {
+	return (n + alignment - 1) / alignment * alignment;
+}
+
+// blocks start at offsets aligned for both their bitmap and their values
+[[nodiscard]] constexpr std::size_t column_block_align(std::size_t value_align) noexcept {
+	return value_align > alignof(validity_word) ? value_align : alignof(validity_word);
+}
+
+// offset of the values from the start of a block
+[[nodiscard]] constexpr std::size_t column_values_offset(column_layout layout, std::size_t block_elements,
+                                                         std::size_t value_align) noexcept {
+	const std::size_t words = block_elements / validity_bits;
+	std::size_t offset      = words * sizeof(validity_word);
+	if (layout == column_layout::sparse)
+		offset += align_up(words * sizeof(std::uint32_t), sizeof(validity_word));
+	return align_up(offset, column_block_align(value_align));
+}
+
+} // non-exported namespace dtl
+} // anonymous namespace
+
+// writes a column of optional<T> of unbounded length to a stream, one block at a time
+template <typename T>
+	requires std::is_trivially_copyable_v<T>
+class optional_column_writer {
+	std::ostream & out_;
+	column_layout layout_;
+	std::size_t block_elements_;
+	std::size_t values_offset_;
+
+	std::vector<dtl::validity_word> bits_;
+	std::vector<unsigned char> values_;
+	std::size_t in_block_ = 0;
+	std::size_t engaged_in_block_ = 0;
+
+	std::uint64_t written_  = 0;
+	std::uint64_t elements_ = 0;
+	std::uint64_t engaged_  = 0;
+	std::vector<std::uint64_t> index_;
+	bool finished_ = false;
+
+	void write(const void * data, std::size_t size) {
+		out_.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+		written_ += size;
+	}
+	void pad_to(std::uint64_t offset) {
+		static constexpr std::array<char, 64> zeros{};
+		while (written_ < offset)
+			write(zeros.data(), std::min<std::uint64_t>(zeros.size(), offset - written_));
+	}
+
+	void flush_block() {
+		pad_to(dtl::align_up(written_, dtl::column_block_align(alignof(T))));
+		const std::uint64_t start = written_;
+		index_.push_back(start);
+		write(bits_.data(), bits_.size() * sizeof(dtl::validity_word));
+		if (layout_ == column_layout::sparse) {
+			std::vector<std::uint32_t> ranks(bits_.size());
+			std::uint32_t rank = 0;
+			for (std::size_t w = 0; w < bits_.size(); ++w) {
+				ranks[w] = rank;
+				rank += static_cast<std::uint32_t>(std::popcount(bits_[w]));
+			}
+			write(ranks.data(), ranks.size() * sizeof(std::uint32_t));
+		}
+		pad_to(start + values_offset_);
+		const std::size_t values = layout_ == column_layout::dense ? in_block_ : engaged_in_block_;
+		write(values_.data(), values * sizeof(T));
+		pad_to(dtl::align_up(written_, alignof(dtl::validity_word)));
+
+		std::fill(bits_.begin(), bits_.end(), dtl::validity_word{ 0 });
+		in_block_         = 0;
+		engaged_in_block_ = 0;
+	}
+
+public:
+	explicit optional_column_writer(std::ostream & out, column_layout layout = column_layout::dense,
+	                                std::size_t block_elements = 65536)
+	: out_(out)
+	, layout_(layout)
+	, block_elements_(block_elements)
+	, values_offset_(dtl::column_values_offset(layout, block_elements, alignof(T)))
+	, bits_(block_elements / dtl::validity_bits)
+	, values_(block_elements * sizeof(T)) {
+		if (block_elements < dtl::validity_bits || !std::has_single_bit(block_elements))
+			throw std::invalid_argument("optional_column_writer: block_elements must be a power of two >= 64");
+		const dtl::column_header header{ dtl::column_magic,
+			                             dtl::column_byte_order,
+			                             dtl::column_version,
+			                             layout,
+			                             static_cast<std::uint32_t>(sizeof(T)),
+			                             static_cast<std::uint32_t>(alignof(T)),
+			                             static_cast<std::uint32_t>(block_elements),
+			                             {} };
+		write(&header, sizeof(header));
+	}
+	optional_column_writer(const optional_column_writer &) = delete;
+	optional_column_writer & operator=(const optional_column_writer &) = delete;
+	~optional_column_writer() {
+		if (!finished_)
+			finish();
+	}
+
+	void push_back(const optional<T> & o) {
+		if (o.has_value()) {
+			dtl::assign_bit(bits_.data(), in_block_, true);
+			const std::size_t slot = layout_ == column_layout::dense ? in_block_ : engaged_in_block_;
+			std::memcpy(values_.data() + slot * sizeof(T), std::addressof(*o), sizeof(T));
+			++engaged_in_block_;
+			++engaged_;
+		} else if (layout_ == column_layout::dense) {
+			std::memset(values_.data() + in_block_ * sizeof(T), 0, sizeof(T));
+		}
+		++elements_;
+		if (++in_block_ == block_elements_)
+			flush_block();
+	}
+
+	template <typename Range>
+	void append(const Range & range) {
+		for (const auto & o : range)
+			push_back(o);
+	}
+
+	[[nodiscard]] std::uint64_t size() const noexcept { return elements_; }
+
+	// writes the pending block, the index and the trailer. Returns the state of the stream.
+	bool finish() {
+		if (!finished_) {
+			finished_ = true;
+			if (in_block_ != 0)
+				flush_block();
+			const std::uint64_t index_offset = written_;
+			write(index_.data(), index_.size() * sizeof(std::uint64_t));
+			const dtl::column_trailer trailer{ elements_, index_offset, engaged_, dtl::column_magic };
+			write(&trailer, sizeof(trailer));
+			out_.flush();
+		}
+		return static_cast<bool>(out_);
+	}
+}; // class optional_column_writer
+
+// read-only view of a serialized column, e.g. in a memory-mapped file. Elements are accessed in
+// place as optional<const T &>. The data must stay alive and unchanged as long as the view is used.
+template <typename T>
+	requires std::is_trivially_copyable_v<T>
+class optional_column_view {
+	const unsigned char * data_ = nullptr;
+	const std::uint64_t * index_ = nullptr;
+	column_layout layout_        = column_layout::dense;
+	std::size_t elements_        = 0;
+	std::size_t engaged_         = 0;
+	std::size_t block_shift_     = 0;
+	std::size_t block_mask_      = 0;
+	std::size_t words_           = 0;
+	std::size_t values_offset_   = 0;
+
+	[[noreturn]] static void malformed(const char * what) {
+		throw std::invalid_argument(what);
+	}
+
+	template <typename U>
+	[[nodiscard]] U load(std::size_t offset) const noexcept {
+		U result;
+		std::memcpy(&result, data_ + offset, sizeof(U));
+		return result;
+	}
+
+	// every block must lie aligned between the header and the index, with a bitmap free of bits
+	// past the last element, ranks matching the bitmap, and room for all of its values
+	void validate_blocks(std::uint64_t blocks, std::uint64_t block_elements, std::uint64_t index_offset) const {
+		std::uint64_t engaged = 0;
+		for (std::uint64_t b = 0; b < blocks; ++b) {
+			const std::uint64_t offset   = index_[b];
+			const std::uint64_t elements = b + 1 < blocks ? block_elements : elements_ - b * block_elements;
+			if (offset < sizeof(dtl::column_header) || offset > index_offset ||
+			    offset % dtl::column_block_align(alignof(T)) != 0 || values_offset_ > index_offset - offset)
+				malformed("optional_column_view: bad block offset");
+
+			const auto * bits  = reinterpret_cast<const dtl::validity_word *>(data_ + offset);
+			const auto * ranks = reinterpret_cast<const std::uint32_t *>(data_ + offset + words_ * sizeof(dtl::validity_word));
+			std::uint64_t engaged_in_block = 0;
+			for (std::size_t w = 0; w < words_; ++w) {
+				const std::uint64_t first = w * dtl::validity_bits;
+				const dtl::validity_word beyond =
+					first >= elements ? bits[w] : first + dtl::validity_bits > elements ? bits[w] >> (elements - first) : 0;
+				if (beyond != 0)
+					malformed("optional_column_view: bad block bitmap");
+				if (layout_ == column_layout::sparse && ranks[w] != engaged_in_block)
+					malformed("optional_column_view: bad block ranks");
+				engaged_in_block += static_cast<std::uint64_t>(std::popcount(bits[w]));
+			}
+
+			const std::uint64_t values = layout_ == column_layout::dense ? elements : engaged_in_block;
+			if (values > (index_offset - offset - values_offset_) / sizeof(T))
+				malformed("optional_column_view: truncated block");
+			engaged += engaged_in_block;
+		}
+		if (engaged != engaged_)
+			malformed("optional_column_view: engaged count mismatch");
+	}
+
+public:
+	constexpr optional_column_view() noexcept = default;
+
+	// throws std::invalid_argument if data doesn't hold a column of T. Validation reads the presence
+	// bitmaps of all blocks, such that element access needs no further checks.
+	explicit optional_column_view(std::span<const std::byte> data)
+	: data_(reinterpret_cast<const unsigned char *>(data.data())) {
+		if (data.size() < sizeof(dtl::column_header) + sizeof(dtl::column_trailer))
+			malformed("optional_column_view: truncated");
+		if (reinterpret_cast<std::uintptr_t>(data_) % alignof(T) != 0 ||
+		    reinterpret_cast<std::uintptr_t>(data_) % alignof(std::uint64_t) != 0)
+			malformed("optional_column_view: misaligned");
+		const auto header = load<dtl::column_header>(0);
+		if (header.magic != dtl::column_magic || header.byte_order != dtl::column_byte_order ||
+		    header.version != dtl::column_version)
+			malformed("optional_column_view: not a column of this platform");
+		if (header.value_size != sizeof(T) || header.value_align != alignof(T))
+			malformed("optional_column_view: value type mismatch");
+		if (header.block_elements < dtl::validity_bits || !std::has_single_bit(header.block_elements) ||
+		    header.layout > column_layout::sparse)
+			malformed("optional_column_view: bad header");
+		const std::uint64_t limit = data.size() - sizeof(dtl::column_trailer);
+		const auto trailer        = load<dtl::column_trailer>(limit);
+		const std::uint64_t blocks =
+			trailer.elements / header.block_elements + (trailer.elements % header.block_elements != 0);
+		if (trailer.magic != dtl::column_magic || trailer.engaged > trailer.elements ||
+		    trailer.index_offset % alignof(std::uint64_t) != 0 || trailer.index_offset > limit ||
+		    blocks > (limit - trailer.index_offset) / sizeof(std::uint64_t))
+			malformed("optional_column_view: bad trailer");
+
+		index_         = reinterpret_cast<const std::uint64_t *>(data_ + trailer.index_offset);
+		layout_        = header.layout;
+		elements_      = static_cast<std::size_t>(trailer.elements);
+		engaged_       = static_cast<std::size_t>(trailer.engaged);
+		block_shift_   = static_cast<std::size_t>(std::countr_zero(header.block_elements));
+		block_mask_    = header.block_elements - 1;
+		words_         = header.block_elements / dtl::validity_bits;
+		values_offset_ = dtl::column_values_offset(layout_, header.block_elements, alignof(T));
+		validate_blocks(blocks, header.block_elements, trailer.index_offset);
+	}
+
+	[[nodiscard]] std::size_t size() const noexcept { return elements_; }
+	[[nodiscard]] bool empty() const noexcept { return elements_ == 0; }
+	[[nodiscard]] std::size_t count_engaged() const noexcept { return engaged_; }
+	[[nodiscard]] column_layout layout() const noexcept { return layout_; }
+
+	[[nodiscard]] bool has_value(std::size_t i) const noexcept {
+		const auto * bits = reinterpret_cast<const dtl::validity_word *>(data_ + index_[i >> block_shift_]);
+		return dtl::test_bit(bits, i & block_mask_);
+	}
+
+	[[nodiscard]] optional<const T &> operator[](std::size_t i) const noexcept {
+		const unsigned char * block = data_ + index_[i >> block_shift_];
+		const auto * bits           = reinterpret_cast<const dtl::validity_word *>(block);
+		const std::size_t j         = i & block_mask_;
+		const dtl::validity_word word = bits[j / dtl::validity_bits];
+		const dtl::validity_word mask = dtl::validity_word{ 1 } << (j % dtl::validity_bits);
+		if (!(word & mask))
+			return none;
+		std::size_t slot = j;
+		if (layout_ == column_layout::sparse) {
+			const auto * ranks = reinterpret_cast<const std::uint32_t *>(block + words_ * sizeof(dtl::validity_word));
+			slot = ranks[j / dtl::validity_bits] + static_cast<std::size_t>(std::popcount(word & (mask - 1)));
+		}
+		return *std::launder(reinterpret_cast<const T *>(block + values_offset_ + slot * sizeof(T)));
+	}
+
+	[[nodiscard]] optional<const T &> at(std::size_t i) const {
+		if (i >= elements_)
+			throw std::out_of_range("optional_column_view::at");
+		return (*this)[i];
+	}
+}; // class optional_column_view
+
+// writes a whole optional_vector
+template <typename T>
+bool write_column(std::ostream & out, const optional_vector<T> & column, column_layout layout = column_layout::dense) {
+	optional_column_writer<T> writer(out, layout);
+	for (std::size_t i = 0; i < column.size(); ++i)
+		writer.push_back(column.has_value(i) ? optional<T>{ column.values()[i] } : optional<T>{});
+	return writer.finish();
+}
+
+} // namespace OPTIONAL_NAMESPACE
+
+#undef OPTIONAL_NAMESPACE
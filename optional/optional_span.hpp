@@ -0,0 +1,106 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#pragma push_macro("OPTIONAL_NAMESPACE")
+#include "optional.hpp"
+#pragma pop_macro("OPTIONAL_NAMESPACE")
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
+#ifndef OPTIONAL_NAMESPACE
+#define OPTIONAL_NAMESPACE boost
+#endif
+
+namespace OPTIONAL_NAMESPACE {
+namespace {
+namespace dtl {
+
+// the n objects of type To with the bytes of the n objects of type From at p, in the same storage.
+// Copying the bytes onto themselves implicitly creates the To objects, like C++23
+// std::start_lifetime_as_array does, and compilers emit no code for it.
+template <typename To, typename From>
+[[nodiscard]] To * start_lifetime_as_array(From * p, std::size_t n) noexcept {
+	static_assert(sizeof(To) == sizeof(From) && alignof(To) == alignof(From) && std::is_trivially_copyable_v<To>);
+	if (n == 0)
+		return reinterpret_cast<To *>(p);
+	return std::launder(static_cast<To *>(std::memmove(p, p, n * sizeof(From))));
+}
+
+// read-only storage must not be written to, not even with its own bytes: the views of constant
+// elements rest on the layout alone
+template <typename To, typename From>
+[[nodiscard]] const To * view_as_array(const From * p) noexcept {
+	static_assert(sizeof(To) == sizeof(From) && alignof(To) == alignof(From) && std::is_trivially_copyable_v<To>);
+	return reinterpret_cast<const To *>(p);
+}
+
+template <typename R>
+concept pointer_range = std::ranges::contiguous_range<R> && std::ranges::borrowed_range<R> &&
+                        std::is_pointer_v<std::ranges::range_value_t<R>>;
+
+template <typename R>
+concept optional_reference_range =
+	std::ranges::contiguous_range<R> && std::ranges::borrowed_range<R> &&
+	optional_type<std::ranges::range_value_t<R>> &&
+	std::is_lvalue_reference_v<typename std::ranges::range_value_t<R>::value_type>;
+
+} // non-exported namespace dtl
+} // anonymous namespace
+
+// views of contiguous pointers as optional references and back, without copying: an
+// optional<T &> is laid out as a T *, a null pointer is a disengaged optional. Writes through
+// either view are seen by the other.
+
+template <typename T, std::size_t Extent>
+	requires dtl::pointer_layout<T>
+[[nodiscard]] std::span<optional<T &>, Extent> as_optionals(std::span<T *, Extent> pointers) noexcept {
+	return std::span<optional<T &>, Extent>(
+		dtl::start_lifetime_as_array<optional<T &>>(pointers.data(), pointers.size()), pointers.size());
+}
+
+template <typename T, std::size_t Extent>
+	requires dtl::pointer_layout<T>
+[[nodiscard]] std::span<const optional<T &>, Extent> as_optionals(std::span<T * const, Extent> pointers) noexcept {
+	return std::span<const optional<T &>, Extent>(dtl::view_as_array<optional<T &>>(pointers.data()),
+	                                              pointers.size());
+}
+
+template <typename T, std::size_t Extent>
+	requires dtl::pointer_layout<T>
+[[nodiscard]] std::span<T *, Extent> as_pointers(std::span<optional<T &>, Extent> optionals) noexcept {
+	return std::span<T *, Extent>(dtl::start_lifetime_as_array<T *>(optionals.data(), optionals.size()),
+	                              optionals.size());
+}
+
+template <typename T, std::size_t Extent>
+	requires dtl::pointer_layout<T>
+[[nodiscard]] std::span<T * const, Extent> as_pointers(std::span<const optional<T &>, Extent> optionals) noexcept {
+	return std::span<T * const, Extent>(dtl::view_as_array<T *>(optionals.data()), optionals.size());
+}
+
+// the same for vectors, arrays and other contiguous ranges which outlive the view
+template <typename R>
+	requires dtl::pointer_range<R>
+[[nodiscard]] auto as_optionals(R && pointers) noexcept {
+	return as_optionals(std::span(pointers));
+}
+
+template <typename R>
+	requires dtl::optional_reference_range<R>
+[[nodiscard]] auto as_pointers(R && optionals) noexcept {
+	return as_pointers(std::span(optionals));
+}
+
+} // namespace OPTIONAL_NAMESPACE
+
+#undef OPTIONAL_NAMESPACE
@@ -0,0 +1,329 @@
+// Copyright (C) 2020, Daniela Engert
+//
+// Use, modification, and distribution is subject to the Boost Software
+// License, Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//
+#pragma once
+
+#pragma push_macro("OPTIONAL_NAMESPACE")
+#include "optional.hpp"
+#pragma pop_macro("OPTIONAL_NAMESPACE")
+
+#include <vector>
+#include <algorithm>
+#include <span>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+
+#ifndef OPTIONAL_NAMESPACE
+#define OPTIONAL_NAMESPACE boost
+#endif
+
+namespace OPTIONAL_NAMESPACE {
+namespace {
+namespace dtl {
+
+using validity_word = std::uint64_t;
+inline constexpr std::size_t validity_bits = 64;
+
+[[nodiscard]] constexpr std::size_t validity_words(std::size_t n) noexcept {
+	return (n + validity_bits - 1) / validity_bits;
+}
+
+[[nodiscard]] constexpr bool test_bit(const validity_word * bits, std::size_t i) noexcept {
+	return (bits[i / validity_bits] >> (i % validity_bits)) & 1u;
+}
+
+constexpr void assign_bit(validity_word * bits, std::size_t i, bool value) noexcept {
+	const validity_word mask = validity_word{ 1 } << (i % validity_bits);
+	validity_word & word     = bits[i / validity_bits];
+	word = value ? word | mask : word & ~mask;
+}
+
+// set or clear the bits [first, last) a word at a time
+constexpr void assign_bits(validity_word * bits, std::size_t first, std::size_t last, bool value) noexcept {
+	while (first < last) {
+		const std::size_t offset = first % validity_bits;
+		const std::size_t count  = std::min(validity_bits - offset, last - first);
+		const validity_word mask =
+			(count == validity_bits ? ~validity_word{ 0 } : (validity_word{ 1 } << count) - 1) << offset;
+		validity_word & word = bits[first / validity_bits];
+		word = value ? word | mask : word & ~mask;
+		first += count;
+	}
+}
+
+// number of set bits in [0, n)
+[[nodiscard]] constexpr std::size_t count_bits(const validity_word * bits, std::size_t n) noexcept {
+	std::size_t result = 0;
+	const std::size_t full = n / validity_bits;
+	for (std::size_t w = 0; w < full; ++w)
+		result += static_cast<std::size_t>(std::popcount(bits[w]));
+	if (const std::size_t rest = n % validity_bits)
+		result += static_cast<std::size_t>(std::popcount(bits[full] & ((validity_word{ 1 } << rest) - 1)));
+	return result;
+}
+
+} // non-exported namespace dtl
+} // anonymous namespace
+
+// columnar sequence of optional<T>: the payloads are stored contiguously, the engagement
+// states are packed into a validity bitmap with one bit per element (bit i % 64 of word i / 64),
+// like the validity buffers of Apache Arrow. Disengaged elements hold a value-initialized T.
+// bool is not supported, std::vector<bool> has no contiguous payloads to hand out as a span.
+template <typename T>
+	requires (std::is_object_v<T> && !std::is_const_v<T> && std::is_default_constructible_v<T> &&
+	          !std::is_same_v<std::remove_volatile_t<T>, bool>)
+class optional_vector {
+	std::vector<T> values_;
+	std::vector<dtl::validity_word> validity_;
+
+	void grow_validity(std::size_t n) { validity_.resize(dtl::validity_words(n), 0); }
+
+	template <bool Const>
+	class basic_iterator {
+		friend class optional_vector;
+		template <bool>
+		friend class basic_iterator;
+		using owner = std::conditional_t<Const, const optional_vector, optional_vector>;
+
+		owner * v_      = nullptr;
+		std::size_t i_  = 0;
+
+		constexpr basic_iterator(owner * v, std::size_t i) noexcept : v_(v), i_(i) {}
+
+	public:
+		using iterator_concept = std::random_access_iterator_tag;
+		using value_type       = optional<std::conditional_t<Const, const T, T> &>;
+		using reference        = value_type;
+		using difference_type  = std::ptrdiff_t;
+
+		constexpr basic_iterator() noexcept = default;
+		template <bool OtherConst>
+			requires (Const && !OtherConst)
+		constexpr basic_iterator(const basic_iterator<OtherConst> & other) noexcept
+		: v_(other.v_), i_(other.i_) {}
+
+		[[nodiscard]] constexpr reference operator*() const { return (*v_)[i_]; }
+		[[nodiscard]] constexpr reference operator[](difference_type n) const { return (*v_)[i_ + n]; }
+
+		constexpr basic_iterator & operator++() noexcept { ++i_; return *this; }
+		constexpr basic_iterator operator++(int) noexcept { auto t = *this; ++i_; return t; }
+		constexpr basic_iterator & operator--() noexcept { --i_; return *this; }
+		constexpr basic_iterator operator--(int) noexcept { auto t = *this; --i_; return t; }
+		constexpr basic_iterator & operator+=(difference_type n) noexcept { i_ += n; return *this; }
+		constexpr basic_iterator & operator-=(difference_type n) noexcept { i_ -= n; return *this; }
+
+		[[nodiscard]] friend constexpr basic_iterator operator+(basic_iterator it, difference_type n) noexcept {
+			return it += n;
+		}
+		[[nodiscard]] friend constexpr basic_iterator operator+(difference_type n, basic_iterator it) noexcept {
+			return it += n;
+		}
+		[[nodiscard]] friend constexpr basic_iterator operator-(basic_iterator it, difference_type n) noexcept {
+			return it -= n;
+		}
+		[[nodiscard]] friend constexpr difference_type operator-(const basic_iterator & lhs,
+		                                                       const basic_iterator & rhs) noexcept {
+			return static_cast<difference_type>(lhs.i_) - static_cast<difference_type>(rhs.i_);
+		}
+		[[nodiscard]] friend constexpr bool operator==(const basic_iterator & lhs, const basic_iterator & rhs) noexcept {
+			return lhs.i_ == rhs.i_;
+		}
+		[[nodiscard]] friend constexpr auto operator<=>(const basic_iterator & lhs,
+		                                                const basic_iterator & rhs) noexcept {
+			return lhs.i_ <=> rhs.i_;
+		}
+	};
+
+public:
+	using value_type      = optional<T>;
+	using reference       = optional<T &>;
+	using const_reference = optional<const T &>;
+	using size_type       = std::size_t;
+	using iterator        = basic_iterator<false>;
+	using const_iterator  = basic_iterator<true>;
+
+	[[nodiscard]] optional_vector() = default;
+	[[nodiscard]] explicit optional_vector(size_type n) : values_(n), validity_(dtl::validity_words(n), 0) {}
+	[[nodiscard]] optional_vector(size_type n, const T & value)
+	: values_(n, value), validity_(dtl::validity_words(n), 0) {
+		dtl::assign_bits(validity_.data(), 0, n, true);
+	}
+	[[nodiscard]] optional_vector(std::initializer_list<optional<T>> il) { append(il.begin(), il.end()); }
+
+	// capacity
+	[[nodiscard]] size_type size() const noexcept { return values_.size(); }
+	[[nodiscard]] bool empty() const noexcept { return values_.empty(); }
+	[[nodiscard]] size_type capacity() const noexcept { return values_.capacity(); }
+
+	void reserve(size_type n) {
+		values_.reserve(n);
+		validity_.reserve(dtl::validity_words(n));
+	}
+	void shrink_to_fit() {
+		values_.shrink_to_fit();
+		validity_.shrink_to_fit();
+	}
+
+	// element access
+	[[nodiscard]] bool has_value(size_type i) const noexcept { return dtl::test_bit(validity_.data(), i); }
+
+	[[nodiscard]] reference operator[](size_type i) noexcept {
+		return has_value(i) ? reference{ values_[i] } : reference{};
+	}
+	[[nodiscard]] const_reference operator[](size_type i) const noexcept {
+		return has_value(i) ? const_reference{ values_[i] } : const_reference{};
+	}
+
+	[[nodiscard]] reference at(size_type i) {
+		if (i >= size())
+			throw std::out_of_range("optional_vector::at");
+		return (*this)[i];
+	}
+	[[nodiscard]] const_reference at(size_type i) const {
+		if (i >= size())
+			throw std::out_of_range("optional_vector::at");
+		return (*this)[i];
+	}
+
+	[[nodiscard]] iterator begin() noexcept { return { this, 0 }; }
+	[[nodiscard]] iterator end() noexcept { return { this, size() }; }
+	[[nodiscard]] const_iterator begin() const noexcept { return { this, 0 }; }
+	[[nodiscard]] const_iterator end() const noexcept { return { this, size() }; }
+	[[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+	[[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+	// raw columnar access: the payloads (including those of disengaged elements) and the
+	// validity bitmap; bits beyond size() are always zero
+	[[nodiscard]] std::span<T> values() noexcept { return values_; }
+	[[nodiscard]] std::span<const T> values() const noexcept { return values_; }
+	[[nodiscard]] std::span<const dtl::validity_word> validity() const noexcept { return validity_; }
+
+	// modifiers
+	void set(size_type i, const T & value) {
+		values_[i] = value;
+		dtl::assign_bit(validity_.data(), i, true);
+	}
+	void set(size_type i, T && value) {
+		values_[i] = static_cast<T &&>(value);
+		dtl::assign_bit(validity_.data(), i, true);
+	}
+	void reset(size_type i) {
+		values_[i] = T{};
+		dtl::assign_bit(validity_.data(), i, false);
+	}
+
+	template <typename... Args>
+	T & emplace_back(Args &&... args) {
+		T & result = values_.emplace_back(static_cast<Args &&>(args)...);
+		grow_validity(size());
+		dtl::assign_bit(validity_.data(), size() - 1, true);
+		return result;
+	}
+	void push_back(const T & value) { emplace_back(value); }
+	void push_back(T && value) { emplace_back(static_cast<T &&>(value)); }
+	void push_back(none_t) {
+		values_.emplace_back();
+		grow_validity(size());
+	}
+	template <typename U>
+		requires dtl::optional_type<U>
+	void push_back(U && value) {
+		if (value)
+			emplace_back(*static_cast<U &&>(value));
+		else
+			push_back(none);
+	}
+
+	void pop_back() {
+		values_.pop_back();
+		dtl::assign_bit(validity_.data(), size(), false);
+		grow_validity(size());
+	}
+
+	// append the range [first, last) of optionals
+	template <std::input_iterator It, std::sentinel_for<It> S>
+		requires dtl::optional_type<std::iter_reference_t<It>>
+	void append(It first, S last) {
+		if constexpr (std::sized_sentinel_for<S, It>)
+			reserve(size() + static_cast<size_type>(last - first));
+		for (; first != last; ++first)
+			push_back(*first);
+	}
+
+	// append all values, engaged
+	void append(std::span<const T> values) {
+		const size_type n = size();
+		values_.insert(values_.end(), values.begin(), values.end());
+		grow_validity(size());
+		dtl::assign_bits(validity_.data(), n, size(), true);
+	}
+
+	// append count disengaged elements
+	void append(size_type count, none_t) { resize(size() + count); }
+
+	// append all values, taking their engagement states from the bits [offset, offset + values.size())
+	void append(std::span<const T> values, const dtl::validity_word * bits, size_type offset = 0) {
+		const size_type n = size();
+		values_.insert(values_.end(), values.begin(), values.end());
+		grow_validity(size());
+		for (size_type i = 0; i < values.size(); ++i)
+			if (dtl::test_bit(bits, offset + i))
+				dtl::assign_bit(validity_.data(), n + i, true);
+			else
+				values_[n + i] = T{};
+	}
+
+	void resize(size_type n) {
+		const size_type old = size();
+		values_.resize(n);
+		if (n < old)
+			dtl::assign_bits(validity_.data(), n, old, false);
+		grow_validity(n);
+	}
+	void resize(size_type n, const T & value) {
+		const size_type old = size();
+		resize(n);
+		if (n > old) {
+			std::fill(values_.begin() + old, values_.end(), value);
+			dtl::assign_bits(validity_.data(), old, n, true);
+		}
+	}
+
+	void clear() noexcept {
+		values_.clear();
+		validity_.clear();
+	}
+
+	void swap(optional_vector & other) noexcept {
+		values_.swap(other.values_);
+		validity_.swap(other.validity_);
+	}
+
+	// bulk observers
+	[[nodiscard]] size_type count_engaged() const noexcept { return dtl::count_bits(validity_.data(), size()); }
+	[[nodiscard]] size_type count_disengaged() const noexcept { return size() - count_engaged(); }
+
+	[[nodiscard]] friend bool operator==(const optional_vector & lhs, const optional_vector & rhs) {
+		if (lhs.size() != rhs.size() || lhs.validity_ != rhs.validity_)
+			return false;
+		for (size_type i = 0; i < lhs.size(); ++i)
+			if (lhs.has_value(i) && !dtl::eq_v(lhs.values_[i], rhs.values_[i]))
+				return false;
+		return true;
+	}
+};
+
+template <typename T>
+void swap(optional_vector<T> & lhs, optional_vector<T> & rhs) noexcept {
+	lhs.swap(rhs);
+}
+
+} // namespace OPTIONAL_NAMESPACE
+
+#undef OPTIONAL_NAMESPACE